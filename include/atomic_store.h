@@ -0,0 +1,28 @@
+#pragma once
+
+#include <FS.h>
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+// Power-fail-safe A/B file slots.
+//
+// A logical file `basePath` is stored as `basePath.0` and `basePath.1`. Each
+// commit is written to the slot that does not hold the newest valid copy and
+// ends with a trailer (magic, generation, length, CRC32). The trailer is the
+// last thing written, so a write cut at any byte leaves the previous copy as
+// the newest valid slot. A plain `basePath` file without trailer written by
+// older firmware is still accepted as a fallback and removed on next commit.
+using AtomicStoreWriteFn = std::function<bool(Print &out)>;
+
+struct AtomicStoreEntry {
+  size_t payloadLength = 0;
+  bool hasCrc = false;  // false for legacy plain files
+  uint32_t crc = 0;     // crc32Finish() value over the payload
+};
+
+bool atomicStoreWrite(fs::FS &fs, const char *basePath, const AtomicStoreWriteFn &writeFn);
+// Opens the newest valid copy positioned at payload start. Payload ends at
+// `entry.payloadLength`; any bytes after that belong to the trailer.
+bool atomicStoreOpenLatest(fs::FS &fs, const char *basePath, File &file, AtomicStoreEntry &entry);
+bool atomicStoreRemove(fs::FS &fs, const char *basePath);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+// Boot phases in the order they normally complete. Timestamps are
+// esp_timer microseconds since the timer started in the bootloader hand-off.
+enum class BootPhase : uint8_t {
+  SerialReady = 0,
+  PanelReset,    // hardResetController() pulse and settle
+  PanelInit,     // TFT_eSPI init sequence
+  PanelWake,     // SLPOUT/DISPON waits
+  FontLoad,
+  DisplayReady,  // glyph atlases built
+  Secrets,       // settings read from NVS
+  CacheLoad,
+  FirstFrame,    // first frame with prices on screen
+  WifiReady,     // connected, including any time in the config portal
+  SetupDone,
+  ClockSynced,
+  OnlineReady,   // first fetch or cache check after the clock sync
+  Count,
+};
+
+// Records the first time `phase` is reached this boot; later calls are ignored.
+void bootMark(BootPhase phase);
+// Logs the phases reached so far with their deltas and saves this boot into
+// the NVS history (one slot per boot, rewritten by later checkpoints).
+// The first checkpoint also logs the previous boots for comparison.
+// Enabled unless built with -D CONFIG_BOOT_PROFILE=0.
+void bootCheckpoint(const char *label);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+enum class ButtonEvent : uint8_t {
+  None = 0,
+  ShortPress,  // released before the long-press threshold
+  LongPress,   // still held at the threshold; fires once per press
+};
+
+// Debounced press-duration state machine. It never waits: the caller feeds
+// it the sampled level on every interrupt or poll and whenever nextCheckMs()
+// comes due, and gets press events back.
+struct ButtonTracker {
+  ButtonTracker(uint32_t debounceMs, uint32_t longPressMs) : debounceMs(debounceMs), longPressMs(longPressMs) {}
+
+  ButtonEvent update(bool pressed, uint32_t nowMs);
+  // When update() must be called again without an edge; false while idle.
+  bool nextCheckMs(uint32_t &dueMs) const;
+
+  uint32_t debounceMs;
+  uint32_t longPressMs;
+  bool rawPressed = false;
+  bool stablePressed = false;
+  bool longFired = false;
+  uint32_t changedMs = 0;
+  uint32_t pressStartMs = 0;
+};
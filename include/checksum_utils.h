@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr uint32_t kCrc32Init = 0xFFFFFFFFu;
+
+// Standard reflected CRC-32 (IEEE 802.3). Feed chunks with the running value
+// starting from kCrc32Init and pass the result through crc32Finish().
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len);
+
+inline uint32_t crc32Finish(uint32_t crc) {
+  return crc ^ 0xFFFFFFFFu;
+}
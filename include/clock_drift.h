@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+// Estimates the local clock's rate error from successive NTP syncs and picks
+// the next resync interval so the error built up in between stays inside a
+// budget. SNTP is stopped between syncs, so the system clock free-runs on
+// the esp_timer timebase (RTC slow clock during light sleep); how far a sync
+// moves it, over how long, is the drift.
+struct ClockDriftTracker {
+  // Spans shorter than this are dominated by NTP jitter, not drift.
+  static constexpr int64_t kMinSpanUs = 30LL * 60LL * 1000000LL;
+
+  // `ntpUs` is the time SNTP set, `monotonicUs` the esp_timer time it was
+  // set at. Returns true when the sync produced a new drift sample.
+  bool addSync(int64_t ntpUs, int64_t monotonicUs);
+  // Falls back to `fallbackSec` until a drift sample exists.
+  time_t resyncIntervalSec(time_t fallbackSec, time_t minSec, time_t maxSec, uint32_t budgetMs) const;
+
+  bool hasSync = false;
+  bool hasDrift = false;
+  int64_t lastNtpUs = 0;
+  int64_t lastMonotonicUs = 0;
+  int32_t lastOffsetMs = 0;  // correction applied by the last sync
+  float driftPpm = 0.0f;     // smoothed; positive when the local clock runs slow
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stdint.h>
+
+// Hand-tuned screen layouts, one type per panel resolution. Members are
+// static constexpr so a profile can be passed as a template argument and
+// all geometry derived from it folds at compile time.
+//
+// Screen coordinate system:
+// - X grows to the right
+// - Y grows downward
+//
+// Quick tuning guide:
+// - Increase X => move right, decrease X => move left
+// - Increase Y => move down, decrease Y => move up
+// - Increase W/H/font size => make larger
+
+// 4.0" ILI9488 — 480x320 landscape
+struct Ili9488LandscapeProfile {
+  static constexpr int kScreenW = 480;
+  static constexpr int kScreenH = 320;
+  static constexpr int kScreenCenterX = 240;
+  static constexpr int kPriceCenterY = 55;
+  static constexpr int kPriceFontSize = 100;
+  static constexpr int kCurrencyFontSize = 40;
+  static constexpr int kChartX = 35;
+  static constexpr int kChartY = 125;
+  static constexpr int kChartW = 420;
+  static constexpr int kChartH = 185;
+  static constexpr int kCurrentArrowHalfWidth = 3;
+  static constexpr int kCurrentArrowHeight = 10;
+  static constexpr int kSourceLabelX = 474;
+  static constexpr int kErrorTitleY = 93;
+  static constexpr int kErrorDetailY = 128;
+  static constexpr int kWifiTitleY = 28;
+  static constexpr int kWifiStep1Y = 77;
+  static constexpr int kWifiApNameY = 107;
+  static constexpr int kWifiStep2Y = 144;
+  static constexpr int kWifiStep3Y = 173;
+  static constexpr int kWifiStep4aY = 202;
+  static constexpr int kWifiStep4bY = 226;
+  static constexpr int kWifiTimeoutY = 258;
+};
+
+// 2.8" ILI9341 — 320x240 landscape
+struct Ili9341LandscapeProfile {
+  static constexpr int kScreenW = 320;
+  static constexpr int kScreenH = 240;
+  static constexpr int kScreenCenterX = 160;
+  static constexpr int kPriceCenterY = 44;
+  static constexpr int kPriceFontSize = 86;
+  static constexpr int kCurrencyFontSize = 34;
+  static constexpr int kChartX = 30;
+  static constexpr int kChartY = 106;
+  static constexpr int kChartW = 286;
+  static constexpr int kChartH = 126;
+  static constexpr int kCurrentArrowHalfWidth = 3;
+  static constexpr int kCurrentArrowHeight = 9;
+  static constexpr int kSourceLabelX = 316;
+  static constexpr int kErrorTitleY = 70;
+  static constexpr int kErrorDetailY = 96;
+  static constexpr int kWifiTitleY = 20;
+  static constexpr int kWifiStep1Y = 58;
+  static constexpr int kWifiApNameY = 80;
+  static constexpr int kWifiStep2Y = 108;
+  static constexpr int kWifiStep3Y = 130;
+  static constexpr int kWifiStep4aY = 152;
+  static constexpr int kWifiStep4bY = 170;
+  static constexpr int kWifiTimeoutY = 194;
+};
+
+// Geometry shared by every profile, derived from the tuned values above.
+template <typename Profile>
+struct DisplayLayout {
+  static constexpr int kDayLabelY = Profile::kChartY - 20;
+  static constexpr int kAxisLabelX = Profile::kChartX - 8;
+  static constexpr int kChartAxisY = Profile::kChartY + Profile::kChartH - 1;
+  static constexpr int kChartDrawableH = Profile::kChartH - 4;
+
+  // Left edge of `slot` when `slots` slots share the chart width.
+  static constexpr int slotX(int slot, int slots) { return Profile::kChartX + ((slot * Profile::kChartW) / slots); }
+
+  // Checked for every profile that is instantiated, not just the one built.
+  static_assert(Profile::kChartX > 8, "chart leaves no room for y-axis ticks");
+  static_assert(Profile::kChartX + Profile::kChartW < Profile::kScreenW, "chart border runs off the right edge");
+  static_assert(Profile::kChartY + Profile::kChartH <= Profile::kScreenH, "chart runs off the bottom edge");
+  static_assert(kDayLabelY > Profile::kPriceCenterY, "day labels overlap the price text");
+  static_assert(Profile::kChartH > 4 + Profile::kCurrentArrowHeight, "chart too short for the current marker");
+  static_assert(Profile::kSourceLabelX < Profile::kScreenW, "source label off screen");
+  static_assert(Profile::kWifiTimeoutY < Profile::kScreenH, "portal text off screen");
+};
+
+// Instantiating these validates the layouts of all panels on every build.
+static_assert(sizeof(DisplayLayout<Ili9488LandscapeProfile>) > 0, "");
+static_assert(sizeof(DisplayLayout<Ili9341LandscapeProfile>) > 0, "");
+
+// Profile for a panel of the given landscape resolution. A panel without a
+// tuned profile has no specialization and fails to compile.
+template <int ScreenW, int ScreenH>
+struct DisplayProfileFor;
+
+template <>
+struct DisplayProfileFor<Ili9488LandscapeProfile::kScreenW, Ili9488LandscapeProfile::kScreenH> {
+  using type = Ili9488LandscapeProfile;
+};
+
+template <>
+struct DisplayProfileFor<Ili9341LandscapeProfile::kScreenW, Ili9341LandscapeProfile::kScreenH> {
+  using type = Ili9341LandscapeProfile;
+};
@@ -2,8 +2,31 @@
 
 #include "app_types.h"
 
+// Lays every screen out with the display_profile.h profile that matches the
+// panel resolution.
 void displayInit();
+// Same with an explicit profile, e.g. for rendering every layout on the host.
+// Instantiated for each profile in display_profile.h.
+template <typename Profile>
+void displayInitFor();
 void displayDrawPrices(const PriceState &state);
+// Makes the next displayDrawPrices() repaint the whole screen.
+void displayInvalidate();
 void displayRefreshClock();
 void displayDrawWifiConfigPortal(const char *apName, uint16_t timeoutSeconds);
-void displayDrawWifiConfigTimeout(uint16_t timeoutSeconds);
+
+// p50/p99 of one draw stage over the recent frames it ran in; the bytes stay
+// 0 unless built with CONFIG_DISPLAY_BUS_STATS.
+struct DisplayStageTiming {
+  const char *name;
+  uint16_t samples;
+  uint32_t p50Us;
+  uint32_t p99Us;
+  uint32_t p50Bytes;
+  uint32_t p99Bytes;
+};
+
+// Copies the stages that have run since displayInitFor() in draw order,
+// the frame total last; returns how many. Always 0 unless built with
+// -D CONFIG_DISPLAY_STAGE_TIMING=1.
+size_t displayStageTimings(DisplayStageTiming *out, size_t maxStages);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <OpenFontRender.h>
+#include <TFT_eSPI.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Small set of anti-aliased glyphs rasterized once through OpenFontRender
+// and kept as 4-bit coverage, so fixed-charset text (the large price and
+// currency code) can be redrawn with plain pixel pushes instead of going
+// through the TrueType rasterizer every time.
+struct AtlasGlyph {
+  char code = 0;
+  uint16_t width = 0;    // ink columns
+  int8_t leftPad = 0;    // gap to the previous glyph is prev.rightPad + leftPad
+  int8_t rightPad = 0;
+  uint32_t offset = 0;   // byte offset into GlyphAtlas::pixels
+};
+
+struct GlyphAtlas {
+  static constexpr size_t kMaxGlyphs = 16;
+
+  AtlasGlyph glyphs[kMaxGlyphs];
+  size_t glyphCount = 0;
+  uint16_t height = 0;              // shared ink rows of the reference glyph
+  const uint8_t *pixels = nullptr;  // two pixels per byte, high nibble first, rows padded to a byte
+  size_t bytes = 0;
+  const int8_t *kerning = nullptr;  // glyphCount x glyphCount, left glyph major; null when folded into the pads
+  bool ownsPixels = false;          // heap copy from glyphAtlasBuild, not flash
+};
+
+// Atlas rasterized at build time by scripts/gen_price_atlas.py, kept in
+// flash. Plain aggregates so the generated tables need no constructors.
+struct PrebuiltGlyph {
+  char code;
+  uint16_t width;   // ink columns
+  int16_t bearing;  // pen position to the first ink column
+  int16_t advance;  // pen position to the next pen position
+  uint32_t offset;  // byte offset into PrebuiltAtlas::pixels
+};
+
+struct PrebuiltAtlas {
+  const char *charset;
+  uint16_t fontSize;
+  uint16_t height;
+  const PrebuiltGlyph *glyphs;  // one per charset character, in order
+  const int8_t *kerning;
+  const uint8_t *pixels;
+  uint32_t bytes;
+};
+
+// Renders every character of `charset` at `fontSize` with the renderer's
+// current font. `reference` must be the tallest glyph of the set; it fixes
+// the baseline and row range all glyphs are cropped to.
+bool glyphAtlasBuild(GlyphAtlas &atlas, OpenFontRender &ofr, TFT_eSPI &tft, const char *charset, char reference,
+                     unsigned fontSize);
+// Points `atlas` at the entry of `prebuilt` for `charset` at `fontSize`
+// without copying. False when there is none.
+bool glyphAtlasAttach(GlyphAtlas &atlas, const PrebuiltAtlas *prebuilt, size_t count, const char *charset,
+                      unsigned fontSize);
+void glyphAtlasFree(GlyphAtlas &atlas);
+// Ink width of `text`, or -1 when a character is not in the atlas.
+int glyphAtlasTextWidth(const GlyphAtlas &atlas, const char *text);
+// Draws `text` with its ink box at (x, y). Returns false without drawing
+// when a character is missing or the box does not fit on the panel.
+bool glyphAtlasDraw(const GlyphAtlas &atlas, TFT_eSPI &tft, const char *text, int x, int y, uint16_t color,
+                    uint16_t background);
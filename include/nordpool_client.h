@@ -1,6 +1,7 @@
 #pragma once
 
 #include "app_types.h"
+#include "write_coalescer.h"
 
 void fetchNordPoolPriceInfo(
     const char *apiBaseUrl,
@@ -12,3 +13,6 @@ void fetchNordPoolPriceInfo(
     PriceState &out);
 void nordPoolPreupdateMovingAverageFromPriceInfo(PriceState &state, float vatPercent, float fixedCostPerKwh);
 bool nordPoolRecalculatePricesFromRaw(PriceState &state, float vatPercent, float fixedCostPerKwh);
+// Moving-average history changes are kept in RAM and committed here at most once a minute.
+void nordPoolFlushMovingAverage();
+const WriteCoalescer &nordPoolMovingAverageWriteStats();
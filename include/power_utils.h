@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+// Dynamic frequency scaling and automatic light sleep while every task is
+// blocked, with WiFi in DTIM modem sleep so the association survives.
+// Enabled unless built with -D CONFIG_POWER_SAVE=0. Automatic light sleep
+// also needs FreeRTOS tickless idle in the framework's sdkconfig; without it
+// only frequency scaling is used and the log says so.
+void powerInit();
+
+// Holds the CPU at full speed while in scope and counts the time as busy,
+// for work that has a latency budget (redraws, the ingest pass).
+class PowerBusyScope {
+ public:
+  PowerBusyScope();
+  ~PowerBusyScope();
+  PowerBusyScope(const PowerBusyScope &) = delete;
+  PowerBusyScope &operator=(const PowerBusyScope &) = delete;
+
+ private:
+  int64_t startUs;
+};
+
+// Makes the pin at the given level a light sleep wake source. This turns the
+// pin's interrupt level-triggered, so its handler must mask it until the
+// level changes back.
+void powerWakeOnPinLevel(int pin, int level);
+// Keeps the chip out of light sleep while held, for inputs that are polled.
+void powerHoldAwake(bool hold);
+
+// How late a wall-clock deadline was served, measured when its handler runs.
+void powerNoteWakeLatency(uint32_t latencyMs);
+// Logs busy duty cycle and wake latency every 15 minutes; call from one task.
+void powerLogSummary();
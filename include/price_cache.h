@@ -1,8 +1,20 @@
 #pragma once
 
 #include "app_types.h"
+#include "write_coalescer.h"
 
-bool priceCacheSave(const PriceState &state);
-bool priceCacheLoadIfCurrent(const char *expectedSource, PriceState &out);
-bool priceCacheLoadIfAvailable(const char *expectedSource, PriceState &out);
+struct PriceCacheCoverage {
+  bool hasCurrentSlot = false;
+  bool hasToday = false;
+  bool hasTomorrow = false;
+};
+
+// Serializes the state and queues it only if the bytes differ from flash.
+// priceCacheFlush() commits the newest queued payload, at most once a minute.
+bool priceCacheQueueSave(const PriceState &state);
+void priceCacheFlush();
+const WriteCoalescer &priceCacheWriteStats();
+// Parses the cache once. Falls back to the first slot as current when the
+// clock slot is not covered; `coverage` tells the caller which case it got.
+bool priceCacheLoad(const char *expectedSource, PriceState &out, PriceCacheCoverage &coverage);
 bool priceCacheClear();
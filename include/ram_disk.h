@@ -0,0 +1,35 @@
+#pragma once
+
+#include <FS.h>
+#include <stddef.h>
+
+struct RamDiskVolume;
+
+// Heap-backed flat filesystem with the same mount interface as SPIFFS and
+// LittleFS, for host tests and for timing the storage layer without flash.
+// Space is accounted in 256-byte pages like SPIFFS; contents are lost on
+// reset. Build with -D CONFIG_STORAGE_RAMDISK=1 to use it as the storage
+// backend.
+class RamDiskFS : public fs::FS {
+ public:
+  explicit RamDiskFS(size_t capacityBytes);
+
+  bool begin(bool formatOnFail = false);
+  void end();
+  bool format();
+  size_t totalBytes();
+  size_t usedBytes();
+  // Bytes programmed since begin(); the wear figure the flash backends lack.
+  size_t bytesWritten();
+
+  // Simulated power cut for fault tests: after `bytes` more bytes are
+  // written, every write, truncate, rename and remove fails until
+  // restorePower(). The write that crosses the limit keeps what fit.
+  void cutPowerAfter(size_t bytes);
+  void restorePower();
+
+ private:
+  RamDiskVolume *volume;
+};
+
+extern RamDiskFS RamDisk;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Why a redraw was asked for; several can be pending at once.
+enum RenderReason : uint8_t {
+  kRenderWarmRestore = 1 << 0,
+  kRenderCacheLoaded = 1 << 1,
+  kRenderFetched = 1 << 2,
+  kRenderSlotChanged = 1 << 3,
+  kRenderConnectivity = 1 << 4,
+  kRenderUserInput = 1 << 5,
+  kRenderSettingsChanged = 1 << 6,
+};
+
+// Collects redraw requests from the app flow so one render covers every
+// change made since the last one, and renders are spaced at least
+// `frameBudgetMs` apart unless the caller flushes before blocking work.
+struct RenderQueue {
+  explicit RenderQueue(uint32_t frameBudgetMs) : frameBudgetMs(frameBudgetMs) {}
+
+  void request(uint8_t reason);
+  bool pending() const { return pendingReasons != 0; }
+  bool due(uint32_t nowMs) const;
+  // When due() turns true; false while nothing is pending.
+  bool nextRenderMs(uint32_t nowMs, uint32_t &dueMs) const;
+  // Clears and returns the pending reasons; the caller renders once for all of them.
+  uint8_t take(uint32_t nowMs);
+
+  uint32_t frameBudgetMs;
+  uint8_t pendingReasons = 0;
+  bool hasRendered = false;
+  uint32_t lastRenderMs = 0;
+  uint32_t requested = 0;
+  uint32_t executed = 0;
+};
+
+// "cache|slot" style list for logs.
+void renderReasonsToString(uint8_t reasons, char *out, size_t outSize);
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+#include <time.h>
+
+#include "app_types.h"
+
+// Compact copy of the displayed price state kept in RTC_NOINIT memory. It
+// survives software, watchdog and panic resets (not power-on), so a warm
+// boot can redraw and resume scheduling without flash or network access.
+bool rtcStateSave(const PriceState &state, const char *timezoneSpec, time_t nextDailyFetch);
+bool rtcStateRestore(PriceState &out, char *timezoneSpec, size_t timezoneSpecSize, time_t &nextDailyFetch);
+void rtcStateClear();
+
+// Counts consecutive warm restores in RTC memory and returns the new count.
+// A fault that follows from the restored state would otherwise reset into it
+// again; the caller falls back to a cold boot past its limit.
+uint8_t rtcStateNoteWarmBoot();
+// Clears the count once the device has run normally after a restore.
+void rtcStateMarkStable();
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <atomic>
+
+// Hands heap-allocated values from one producer task to one consumer task
+// through a single atomic pointer swap. post() gives up ownership; take()
+// claims the newest value. Each side only ever touches a value it owns, so
+// nothing is locked while the producer builds the next value or the
+// consumer works on the last one. Values posted faster than they are taken
+// come back from post() for the producer to free.
+template <typename T>
+struct SnapshotMailbox {
+  // Returns the previous value if the consumer never took it, else nullptr.
+  T *post(T *value) { return slot.exchange(value, std::memory_order_acq_rel); }
+  // Returns the newest posted value or nullptr; the caller owns it.
+  T *take() { return slot.exchange(nullptr, std::memory_order_acq_rel); }
+
+  std::atomic<T *> slot{nullptr};
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <FS.h>
+
+// Single owner of the flash filesystem. The backend is SPIFFS by default;
+// build with -D CONFIG_STORAGE_LITTLEFS=1 to use LittleFS on the same
+// partition instead (the partition is reformatted on first mount), or with
+// -D CONFIG_STORAGE_RAMDISK=1 for the heap-backed RAM disk of ram_disk.h.
+bool storageMount();
+fs::FS &storageFs();
+const char *storageBackendName();
+
+// Times open/write/read/rename/remove and A/B commits at the cache and
+// moving-average file sizes and logs the results. Destructive only to its
+// own scratch files. Enabled at boot with -D CONFIG_STORAGE_BENCHMARK=1.
+void storageRunBenchmark();
@@ -23,6 +23,21 @@ bool shouldCatchUpMissedDailyUpdate(
     int dailyFetchHour,
     int dailyFetchMinute,
     time_t validEpochMin);
+// True when the state has a slot on the local calendar day `dayOffset` days after `now`.
+bool stateCoversLocalDay(const PriceState &state, time_t now, int dayOffset, time_t validEpochMin);
 const char *timezoneSpecForNordpoolArea(const String &area);
-void syncClock(const char *timezoneSpec);
+void applyTimezone(const char *timezoneSpec);
+
+struct ClockSyncSample {
+  int64_t ntpUs = 0;        // time SNTP set, microseconds since the epoch
+  int64_t monotonicUs = 0;  // esp_timer_get_time() when it was set
+};
+
+// Called from the SNTP callback on the lwIP task; must only wake a task.
+using ClockSyncListener = void (*)();
+
+// Starts SNTP and returns at once; `onSync` runs when the answer is applied.
+void startClockSync(const char *timezoneSpec, ClockSyncListener onSync);
+// Claims a completed sync and stops SNTP until the next startClockSync().
+bool takeClockSync(ClockSyncSample &out);
 time_t scheduleNextDailyFetch(time_t now, int hour, int minute);
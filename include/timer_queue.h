@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Deadlines on the millis() clock kept in a binary min-heap, so the main
+// loop can sleep until the earliest one instead of polling every job.
+// Each id has at most one pending deadline; scheduling it again moves it.
+// Comparisons are wrap-safe for deadlines less than ~24 days apart.
+struct TimerQueue {
+  static constexpr size_t kMaxTimers = 12;
+
+  struct Entry {
+    uint8_t id = 0;
+    uint32_t dueMs = 0;
+  };
+
+  // Returns false when the queue is full and `id` is not already pending.
+  bool schedule(uint8_t id, uint32_t dueMs);
+  void cancel(uint8_t id);
+  bool scheduled(uint8_t id) const;
+  // Milliseconds until the earliest deadline, capped at `maxWaitMs`.
+  uint32_t waitMs(uint32_t nowMs, uint32_t maxWaitMs) const;
+  // Removes the earliest deadline if it is due at `nowMs`.
+  bool popDue(uint32_t nowMs, uint8_t &id);
+
+  Entry entries[kMaxTimers];
+  size_t size = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include <WString.h>
 
@@ -14,6 +15,49 @@ struct AppSecrets {
 };
 
 void loadAppSecrets(AppSecrets &out);
-bool wifiConnectWithConfigPortal(AppSecrets &secrets, uint16_t portalTimeoutSeconds);
-bool wifiReconnect(uint32_t timeoutMs);
+// Connects to the last AP if it answers a directed attempt and returns true.
+// Otherwise returns false at once: with stored credentials a full scan goes
+// on in the link state machine, which opens the portal if it fails and
+// reports kPortalOpened; without them the config portal opens right away
+// next to the station (AP+STA). The link state machine makes no attempts of
+// its own while the portal is open. `drawPortalScreen` paints setup
+// instructions over whatever is shown when the portal opens right away.
+bool wifiConnectWithConfigPortal(AppSecrets &secrets, uint16_t portalTimeoutSeconds, bool drawPortalScreen);
+
+// Returned by wifiPortalService().
+constexpr uint8_t kPortalSourceSettingsChanged = 1 << 0;   // API URL, area, currency or resolution
+constexpr uint8_t kPortalFormulaSettingsChanged = 1 << 1;  // VAT or fixed cost
+constexpr uint8_t kPortalClosed = 1 << 2;                  // timed out or finished
+constexpr uint8_t kPortalOpened = 1 << 3;                  // after the boot scan failed
+
+// Picks up what the open portal did; settings saved there are stored and
+// applied to `secrets` before returning. The portal itself runs on its own
+// task, so a save that connects to a new network blocks nobody else. Call
+// whenever the link listener fires or wifiLinkNextCheckMs() is due.
+// A portal that times out with no stored credentials reopens instead of
+// closing, so the setup screen drawn for it stays accurate.
+uint8_t wifiPortalService(AppSecrets &secrets);
+bool wifiPortalActive();
+// SSID of the portal's access point, for the setup screen.
+void wifiPortalApName(char *out, size_t size);
+
+enum class WifiLinkState : uint8_t {
+  Idle = 0,    // not started, or no stored credentials
+  Connecting,  // directed attempt at the cached AP, then a full scan
+  Connected,
+  Backoff,     // waiting after a failed attempt; doubles up to a minute
+};
+
+// Called from the WiFi event task on link changes and from the portal task;
+// must only wake a task.
+using WifiLinkListener = void (*)();
+
+// Takes over reconnects from the Arduino core. Attempts never block: the
+// caller runs wifiLinkService() whenever `onChange` fires or
+// wifiLinkNextCheckMs() comes due. The listener also fires when a portal
+// form is saved or the portal closes.
+void wifiLinkBegin(uint32_t connectTimeoutMs, WifiLinkListener onChange);
+WifiLinkState wifiLinkService(uint32_t nowMs);
+bool wifiLinkNextCheckMs(uint32_t &dueMs);
+const char *wifiLinkStateName(WifiLinkState state);
 void wifiResetSettings();
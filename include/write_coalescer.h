@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+// Tracks whether a persisted payload changed and rate-limits its flushes.
+// Callers hash the serialized payload; identical content never reaches
+// flash, and changed content is written at most once per `minIntervalMs`
+// with only the newest payload committed.
+struct WriteCoalescer {
+  explicit WriteCoalescer(uint32_t minIntervalMs) : minIntervalMs(minIntervalMs) {}
+
+  // Returns true when `hash` differs from what is on flash and the payload
+  // must be kept for the next flush.
+  bool markIfChanged(uint32_t hash);
+  bool flushDue(uint32_t nowMs) const;
+  // When flushDue() turns true; false while nothing is pending.
+  bool nextFlushMs(uint32_t nowMs, uint32_t &dueMs) const;
+  void flushed(bool ok, uint32_t nowMs);
+  // Records the hash of content already on flash, e.g. after a load.
+  void committed(uint32_t hash);
+  void reset();
+
+  uint32_t minIntervalMs;
+  bool dirty = false;
+  bool hasCommittedHash = false;
+  uint32_t committedHash = 0;
+  uint32_t pendingHash = 0;
+  bool hasFlushed = false;
+  uint32_t lastFlushMs = 0;
+  uint32_t writesPerformed = 0;
+  uint32_t writesAvoided = 0;
+};
@@ -0,0 +1,209 @@
+"""Rasterizes the large price and currency glyphs at build time.
+
+PlatformIO pre-script (extra_scripts in platformio.ini). Renders the glyphs
+of kPriceAtlasGlyphs and kCurrencyAtlasGlyphs from the NotoSans_Bold array
+in include/ with FreeType, at the font sizes of the display profile matching
+TFT_WIDTH/TFT_HEIGHT, into $BUILD_DIR/generated/price_atlas_data.h: 4-bit
+coverage, per-glyph advances and a kerning table, all in flash. Defines
+CONFIG_DISPLAY_PRICE_ATLAS_PREBUILT=1 so display_ui.cpp attaches them
+instead of rasterizing through OpenFontRender at boot.
+
+Needs freetype-py (pip install freetype-py). Without it the build goes on
+and the atlases are rasterized at boot as before.
+
+Also runs standalone, for all profiles:
+    python scripts/gen_price_atlas.py <out.h>
+"""
+
+import io
+import os
+import re
+import sys
+
+# Must match kPriceAtlasGlyphs and kCurrencyAtlasGlyphs in display_ui.cpp,
+# with the reference glyph that fixes the shared rows. A mismatch is caught
+# at boot and falls back to the runtime atlas.
+ATLASES = (
+    ("Price", "0123456789.-", "0", "kPriceFontSize"),
+    ("Currency", "DEKNORSU", "E", "kCurrencyFontSize"),
+)
+HEADER_NAME = "price_atlas_data.h"
+DEFINE = "CONFIG_DISPLAY_PRICE_ATLAS_PREBUILT"
+
+
+def read_font(font_header):
+    """TrueType bytes of the C array in include/NotoSans_Bold.h."""
+    with open(font_header) as f:
+        text = f.read()
+    body = text[text.index("{") + 1 : text.rindex("}")]
+    return bytes(int(value, 16) for value in re.findall(r"0x([0-9A-Fa-f]{2})", body))
+
+
+def read_profiles(profile_header):
+    """{name: {member: value}} of the profile structs in display_profile.h."""
+    with open(profile_header) as f:
+        text = f.read()
+    profiles = {}
+    for name, body in re.findall(r"struct (\w+Profile) \{(.*?)\n\};", text, re.S):
+        profiles[name] = {
+            member: int(value) for member, value in re.findall(r"static constexpr int (k\w+) = (-?\d+);", body)
+        }
+    return profiles
+
+
+def render_atlas(face, charset, reference, size):
+    """Glyph metrics, kerning and 4-bit rows cropped to the reference's ink rows."""
+    import freetype
+
+    face.set_pixel_sizes(0, size)
+    face.load_char(reference, freetype.FT_LOAD_RENDER)
+    top = face.glyph.bitmap_top
+    height = face.glyph.bitmap.rows
+
+    glyphs = []
+    pixels = bytearray()
+    for code in charset:
+        face.load_char(code, freetype.FT_LOAD_RENDER)
+        slot = face.glyph
+        bitmap = slot.bitmap
+        width = bitmap.width
+        stride = (width + 1) // 2
+        glyphs.append((code, width, slot.bitmap_left, (slot.advance.x + 32) >> 6, len(pixels)))
+        rows = bytearray(stride * height)
+        for row in range(height):
+            # Row `row` of the atlas is `top - row` above the baseline.
+            source_row = slot.bitmap_top - top + row
+            if source_row < 0 or source_row >= bitmap.rows:
+                continue
+            line = bitmap.buffer[source_row * bitmap.pitch : source_row * bitmap.pitch + width]
+            for col, value in enumerate(line):
+                coverage = (value * 15 + 127) // 255
+                rows[row * stride + col // 2] |= coverage if col & 1 else coverage << 4
+        pixels += rows
+
+    kerning = []
+    for left in charset:
+        for right in charset:
+            kerning.append((face.get_kerning(left, right).x + 32) >> 6)
+    return height, glyphs, kerning, bytes(pixels)
+
+
+def byte_lines(data, indent="  ", per_line=16):
+    return "\n".join(
+        indent + ", ".join("0x%02X" % b for b in data[i : i + per_line]) + "," for i in range(0, len(data), per_line)
+    )
+
+
+def write_header(out_path, font, sizes):
+    """`sizes` maps an atlas name (Price, Currency) to the font sizes to render."""
+    import freetype
+
+    face = freetype.Face(io.BytesIO(font))
+    tables = []
+    entries = []
+    for name, charset, reference, _ in ATLASES:
+        for size in sorted(set(sizes[name])):
+            height, glyphs, kerning, pixels = render_atlas(face, charset, reference, size)
+            prefix = "k%s%d" % (name, size)
+            tables.append(
+                "const PrebuiltGlyph %sGlyphs[] = {\n%s\n};\n"
+                % (prefix, "\n".join("  {'%s', %d, %d, %d, %d}," % glyph for glyph in glyphs))
+            )
+            count = len(charset)
+            kerning_rows = "\n".join(
+                "  " + ", ".join(str(k) for k in kerning[i : i + count]) + "," for i in range(0, len(kerning), count)
+            )
+            tables.append("const int8_t %sKerning[] = {\n%s\n};\n" % (prefix, kerning_rows))
+            tables.append("const uint8_t %sPixels[] PROGMEM = {\n%s\n};\n" % (prefix, byte_lines(pixels)))
+            entries.append(
+                '  {"%s", %d, %d, %sGlyphs, %sKerning, %sPixels, %d},'
+                % (charset, size, height, prefix, prefix, prefix, len(pixels))
+            )
+
+    text = (
+        "// Generated by scripts/gen_price_atlas.py from NotoSans_Bold.h. Do not edit.\n"
+        "#pragma once\n\n"
+        '#include "glyph_atlas.h"\n\n'
+        "namespace {\n"
+        + "\n".join(tables)
+        + "\nconst PrebuiltAtlas kPrebuiltPriceAtlases[] = {\n"
+        + "\n".join(entries)
+        + "\n};\n"
+        "}  // namespace\n"
+    )
+    os.makedirs(os.path.dirname(os.path.abspath(out_path)), exist_ok=True)
+    with open(out_path, "w") as f:
+        f.write(text)
+
+
+def profile_sizes(profiles, screen):
+    """Font sizes of the profile for `screen` (landscape w, h), or of all of them."""
+    selected = [p for p in profiles.values() if screen is not None and (p["kScreenW"], p["kScreenH"]) == screen]
+    selected = selected or list(profiles.values())
+    return {name: [p[member] for p in selected] for name, _, _, member in ATLASES}
+
+
+def panel_screen(build_flags):
+    """Landscape resolution from the TFT_WIDTH/TFT_HEIGHT build flags."""
+    width = re.search(r"-D\s*TFT_WIDTH=(\d+)", build_flags)
+    height = re.search(r"-D\s*TFT_HEIGHT=(\d+)", build_flags)
+    if not width or not height:
+        return None
+    a, b = int(width.group(1)), int(height.group(1))
+    return (max(a, b), min(a, b))
+
+
+def configure(env):
+    project_dir = env.subst("$PROJECT_DIR")
+    font_header = os.path.join(project_dir, "include", "NotoSans_Bold.h")
+    profile_header = os.path.join(project_dir, "include", "display_profile.h")
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")
+    out_path = os.path.join(out_dir, HEADER_NAME)
+
+    try:
+        import freetype  # noqa: F401
+    except ImportError:
+        print("Price atlas: freetype-py not installed, glyphs are rasterized at boot")
+        return
+
+    build_flags = env.GetProjectOption("build_flags", [])
+    if not isinstance(build_flags, str):
+        build_flags = " ".join(build_flags)
+    # SCons runs this without __file__.
+    inputs = (os.path.join(project_dir, "scripts", "gen_price_atlas.py"), font_header, profile_header)
+    stamp = os.path.join(out_dir, HEADER_NAME + ".flags")
+    previous_flags = None
+    if os.path.exists(stamp):
+        with open(stamp) as f:
+            previous_flags = f.read()
+    stale = (
+        not os.path.exists(out_path)
+        or previous_flags != build_flags
+        or any(os.path.getmtime(path) > os.path.getmtime(out_path) for path in inputs)
+    )
+    if stale:
+        sizes = profile_sizes(read_profiles(profile_header), panel_screen(build_flags))
+        write_header(out_path, read_font(font_header), sizes)
+        with open(stamp, "w") as f:
+            f.write(build_flags)
+        print("Price atlas: generated %s" % out_path)
+
+    env.Append(CPPPATH=[out_dir], CPPDEFINES=[(DEFINE, 1)])
+
+
+def main(argv):
+    if len(argv) != 2:
+        print(__doc__)
+        return 2
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    profiles = read_profiles(os.path.join(root, "include", "display_profile.h"))
+    write_header(argv[1], read_font(os.path.join(root, "include", "NotoSans_Bold.h")), profile_sizes(profiles, None))
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821
+except NameError:
+    sys.exit(main(sys.argv))
+else:
+    configure(env)  # noqa: F821
@@ -0,0 +1,223 @@
+#include "atomic_store.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "checksum_utils.h"
+#include "logging_utils.h"
+
+namespace {
+constexpr uint32_t kTrailerMagic = 0x41425354;  // "ABST"
+constexpr size_t kSlotCount = 2;
+constexpr size_t kSlotPathMax = 40;
+constexpr size_t kChunkSize = 256;
+
+struct Trailer {
+  uint32_t magic;
+  uint32_t generation;
+  uint32_t length;
+  uint32_t crc;
+};
+static_assert(sizeof(Trailer) == 16, "trailer layout must stay stable on flash");
+
+struct SlotInfo {
+  bool valid = false;
+  uint32_t generation = 0;
+  size_t length = 0;
+  uint32_t crc = 0;
+};
+
+// Buffers payload bytes so each flash write is a full chunk instead of the
+// per-character writes ArduinoJson issues, and checksums what was written.
+class ChecksumPrint : public Print {
+ public:
+  explicit ChecksumPrint(File &target) : target(target) {}
+
+  size_t write(uint8_t value) override {
+    return write(&value, 1);
+  }
+
+  size_t write(const uint8_t *data, size_t size) override {
+    if (failed) return 0;
+    size_t consumed = 0;
+    while (consumed < size) {
+      size_t take = size - consumed;
+      if (take > kChunkSize - used) take = kChunkSize - used;
+      memcpy(buffer + used, data + consumed, take);
+      used += take;
+      consumed += take;
+      if (used == kChunkSize && !drain()) return 0;
+    }
+    return size;
+  }
+
+  bool finish() {
+    return drain() && !failed;
+  }
+
+  uint32_t crc = kCrc32Init;
+  uint32_t length = 0;
+  bool failed = false;
+
+ private:
+  bool drain() {
+    if (used == 0 || failed) return !failed;
+    if (target.write(buffer, used) != used) {
+      failed = true;
+      return false;
+    }
+    crc = crc32Update(crc, buffer, used);
+    length += used;
+    used = 0;
+    return true;
+  }
+
+  File &target;
+  uint8_t buffer[kChunkSize];
+  size_t used = 0;
+};
+
+void slotPath(const char *basePath, size_t slot, char *out, size_t outSize) {
+  snprintf(out, outSize, "%s.%u", basePath, (unsigned)slot);
+}
+
+bool isNewerGeneration(uint32_t candidate, uint32_t reference) {
+  return (int32_t)(candidate - reference) > 0;
+}
+
+SlotInfo inspectSlot(fs::FS &fs, const char *path) {
+  SlotInfo info;
+  if (!fs.exists(path)) return info;
+
+  File file = fs.open(path, FILE_READ);
+  if (!file) return info;
+
+  const size_t size = file.size();
+  Trailer trailer;
+  if (size < sizeof(Trailer) || !file.seek(size - sizeof(Trailer)) ||
+      file.read((uint8_t *)&trailer, sizeof(Trailer)) != sizeof(Trailer)) {
+    file.close();
+    return info;
+  }
+  if (trailer.magic != kTrailerMagic || trailer.length != size - sizeof(Trailer) || !file.seek(0)) {
+    file.close();
+    return info;
+  }
+
+  uint8_t chunk[kChunkSize];
+  uint32_t crc = kCrc32Init;
+  size_t remaining = trailer.length;
+  while (remaining > 0) {
+    const size_t want = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+    const size_t got = file.read(chunk, want);
+    if (got != want) {
+      file.close();
+      return info;
+    }
+    crc = crc32Update(crc, chunk, got);
+    remaining -= got;
+  }
+  file.close();
+  if (crc32Finish(crc) != trailer.crc) return info;
+
+  info.valid = true;
+  info.generation = trailer.generation;
+  info.length = trailer.length;
+  info.crc = trailer.crc;
+  return info;
+}
+
+int findLatestSlot(fs::FS &fs, const char *basePath, SlotInfo &latest) {
+  int latestSlot = -1;
+  for (size_t slot = 0; slot < kSlotCount; ++slot) {
+    char path[kSlotPathMax];
+    slotPath(basePath, slot, path, sizeof(path));
+    const SlotInfo info = inspectSlot(fs, path);
+    if (!info.valid) continue;
+    if (latestSlot < 0 || isNewerGeneration(info.generation, latest.generation)) {
+      latestSlot = (int)slot;
+      latest = info;
+    }
+  }
+  return latestSlot;
+}
+}  // namespace
+
+bool atomicStoreWrite(fs::FS &fs, const char *basePath, const AtomicStoreWriteFn &writeFn) {
+  SlotInfo latest;
+  const int latestSlot = findLatestSlot(fs, basePath, latest);
+  const size_t targetSlot = latestSlot < 0 ? 0 : (size_t)(1 - latestSlot);
+  const uint32_t generation = latestSlot < 0 ? 1 : latest.generation + 1;
+
+  char path[kSlotPathMax];
+  slotPath(basePath, targetSlot, path, sizeof(path));
+  File file = fs.open(path, FILE_WRITE);
+  if (!file) {
+    logf("Atomic store open failed: %s", path);
+    return false;
+  }
+
+  ChecksumPrint payload(file);
+  if (!writeFn(payload) || !payload.finish()) {
+    file.close();
+    fs.remove(path);
+    logf("Atomic store payload write failed: %s", path);
+    return false;
+  }
+
+  Trailer trailer;
+  trailer.magic = kTrailerMagic;
+  trailer.generation = generation;
+  trailer.length = payload.length;
+  trailer.crc = crc32Finish(payload.crc);
+  const bool trailerOk = file.write((const uint8_t *)&trailer, sizeof(Trailer)) == sizeof(Trailer);
+  file.flush();
+  file.close();
+  if (!trailerOk) {
+    logf("Atomic store trailer write failed: %s", path);
+    return false;
+  }
+
+  // Read back before dropping the legacy copy; the other slot stays untouched either way.
+  if (!inspectSlot(fs, path).valid) {
+    logf("Atomic store verify failed: %s", path);
+    return false;
+  }
+  if (fs.exists(basePath)) {
+    fs.remove(basePath);
+  }
+  return true;
+}
+
+bool atomicStoreOpenLatest(fs::FS &fs, const char *basePath, File &file, AtomicStoreEntry &entry) {
+  entry = AtomicStoreEntry();
+  SlotInfo latest;
+  const int latestSlot = findLatestSlot(fs, basePath, latest);
+  if (latestSlot >= 0) {
+    char path[kSlotPathMax];
+    slotPath(basePath, (size_t)latestSlot, path, sizeof(path));
+    file = fs.open(path, FILE_READ);
+    if (!file) return false;
+    entry.payloadLength = latest.length;
+    entry.hasCrc = true;
+    entry.crc = latest.crc;
+    return true;
+  }
+
+  if (!fs.exists(basePath)) return false;
+  file = fs.open(basePath, FILE_READ);
+  if (!file) return false;
+  entry.payloadLength = file.size();
+  return true;
+}
+
+bool atomicStoreRemove(fs::FS &fs, const char *basePath) {
+  bool ok = true;
+  for (size_t slot = 0; slot < kSlotCount; ++slot) {
+    char path[kSlotPathMax];
+    slotPath(basePath, slot, path, sizeof(path));
+    if (fs.exists(path) && !fs.remove(path)) ok = false;
+  }
+  if (fs.exists(basePath) && !fs.remove(basePath)) ok = false;
+  return ok;
+}
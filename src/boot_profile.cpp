@@ -0,0 +1,144 @@
+#include "boot_profile.h"
+
+#include <Preferences.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#include "logging_utils.h"
+
+#ifndef CONFIG_BOOT_PROFILE
+#define CONFIG_BOOT_PROFILE 1
+#endif
+
+#ifndef CONFIG_BOOT_PROFILE_HISTORY
+#define CONFIG_BOOT_PROFILE_HISTORY 8
+#endif
+
+namespace {
+constexpr size_t kPhaseCount = (size_t)BootPhase::Count;
+constexpr size_t kHistorySize = CONFIG_BOOT_PROFILE_HISTORY > 0 ? CONFIG_BOOT_PROFILE_HISTORY : 1;
+constexpr char kPrefsNamespace[] = "bootprof";
+constexpr char kHistoryKey[] = "history";
+constexpr uint16_t kHistoryVersion = 1;
+
+constexpr const char *kPhaseNames[] = {
+    "serial",
+    "panel-reset",
+    "panel-init",
+    "panel-wake",
+    "font-load",
+    "display-ready",
+    "secrets",
+    "cache-load",
+    "first-frame",
+    "wifi",
+    "setup-done",
+    "clock-sync",
+    "online",
+};
+static_assert(sizeof(kPhaseNames) / sizeof(kPhaseNames[0]) == kPhaseCount, "one name per boot phase");
+
+struct BootRecord {
+  uint32_t sequence;  // 0 marks an empty slot
+  uint8_t resetReason;
+  uint32_t phaseUs[kPhaseCount];  // 0 when the phase was not reached
+};
+
+struct BootHistory {
+  uint16_t version;
+  uint16_t next;
+  uint32_t lastSequence;
+  BootRecord records[kHistorySize];
+};
+static_assert(sizeof(BootHistory) < 1984, "keep the history inside one NVS blob page");
+
+BootRecord gCurrent = {};
+BootHistory gHistory = {};
+int gSlot = -1;  // this boot's slot once loaded
+
+void loadHistory() {
+  Preferences prefs;
+  bool loaded = false;
+  if (prefs.begin(kPrefsNamespace, true)) {
+    loaded = prefs.getBytesLength(kHistoryKey) == sizeof(gHistory) &&
+             prefs.getBytes(kHistoryKey, &gHistory, sizeof(gHistory)) == sizeof(gHistory) &&
+             gHistory.version == kHistoryVersion && gHistory.next < kHistorySize;
+    prefs.end();
+  }
+  if (!loaded) {
+    memset(&gHistory, 0, sizeof(gHistory));
+    gHistory.version = kHistoryVersion;
+  }
+}
+
+void saveHistory() {
+  Preferences prefs;
+  if (!prefs.begin(kPrefsNamespace, false)) {
+    logf("Boot profile save failed: prefs begin");
+    return;
+  }
+  prefs.putBytes(kHistoryKey, &gHistory, sizeof(gHistory));
+  prefs.end();
+}
+
+unsigned long phaseMs(const BootRecord &record, BootPhase phase) {
+  return (unsigned long)(record.phaseUs[(size_t)phase] / 1000);
+}
+
+// Oldest first, so the log reads as a trend.
+void logHistory() {
+  for (size_t i = 0; i < kHistorySize; ++i) {
+    const BootRecord &record = gHistory.records[(gHistory.next + i) % kHistorySize];
+    if (record.sequence == 0) continue;
+    logf(
+        "Boot history: seq=%lu reset=%u display=%lu frame=%lu wifi=%lu setup=%lu clock=%lu online=%lu ms",
+        (unsigned long)record.sequence,
+        (unsigned)record.resetReason,
+        phaseMs(record, BootPhase::DisplayReady),
+        phaseMs(record, BootPhase::FirstFrame),
+        phaseMs(record, BootPhase::WifiReady),
+        phaseMs(record, BootPhase::SetupDone),
+        phaseMs(record, BootPhase::ClockSynced),
+        phaseMs(record, BootPhase::OnlineReady));
+  }
+}
+}  // namespace
+
+void bootMark(BootPhase phase) {
+  if (!CONFIG_BOOT_PROFILE || phase >= BootPhase::Count) return;
+  uint32_t &slot = gCurrent.phaseUs[(size_t)phase];
+  if (slot != 0) return;
+  // Phases reached after ~71 minutes (a long portal or outage) would wrap.
+  const int64_t us = esp_timer_get_time();
+  slot = us < (int64_t)UINT32_MAX ? (uint32_t)us : UINT32_MAX;
+}
+
+void bootCheckpoint(const char *label) {
+  if (!CONFIG_BOOT_PROFILE) return;
+
+  uint32_t previousUs = 0;
+  for (size_t i = 0; i < kPhaseCount; ++i) {
+    const uint32_t us = gCurrent.phaseUs[i];
+    if (us == 0) continue;
+    // Phases can complete out of order (the portal, a warm restore); show them as they fell.
+    logf(
+        "Boot %s: %-13s at %8lu us  +%lu us",
+        label,
+        kPhaseNames[i],
+        (unsigned long)us,
+        (unsigned long)(us >= previousUs ? us - previousUs : 0));
+    if (us > previousUs) previousUs = us;
+  }
+
+  if (gSlot < 0) {
+    loadHistory();
+    logHistory();
+    gSlot = gHistory.next;
+    gHistory.next = (uint16_t)((gHistory.next + 1) % kHistorySize);
+    gCurrent.sequence = ++gHistory.lastSequence;
+    gCurrent.resetReason = (uint8_t)esp_reset_reason();
+  }
+  gHistory.records[gSlot] = gCurrent;
+  saveHistory();
+}
@@ -0,0 +1,38 @@
+#include "button_tracker.h"
+
+ButtonEvent ButtonTracker::update(bool pressed, uint32_t nowMs) {
+  if (pressed != rawPressed) {
+    rawPressed = pressed;
+    changedMs = nowMs;
+    return ButtonEvent::None;
+  }
+  if (nowMs - changedMs < debounceMs) return ButtonEvent::None;
+
+  if (rawPressed != stablePressed) {
+    stablePressed = rawPressed;
+    if (stablePressed) {
+      pressStartMs = changedMs;
+      longFired = false;
+    } else if (!longFired) {
+      return ButtonEvent::ShortPress;
+    }
+  }
+
+  if (stablePressed && !longFired && nowMs - pressStartMs >= longPressMs) {
+    longFired = true;
+    return ButtonEvent::LongPress;
+  }
+  return ButtonEvent::None;
+}
+
+bool ButtonTracker::nextCheckMs(uint32_t &dueMs) const {
+  if (rawPressed != stablePressed) {
+    dueMs = changedMs + debounceMs;
+    return true;
+  }
+  if (stablePressed && !longFired) {
+    dueMs = pressStartMs + longPressMs;
+    return true;
+  }
+  return false;
+}
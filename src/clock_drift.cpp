@@ -0,0 +1,31 @@
+#include "clock_drift.h"
+
+#include <math.h>
+
+bool ClockDriftTracker::addSync(int64_t ntpUs, int64_t monotonicUs) {
+  const bool hadSync = hasSync;
+  const int64_t spanUs = monotonicUs - lastMonotonicUs;
+  // Where the free-running clock had got to when SNTP replaced it.
+  const int64_t offsetUs = ntpUs - (lastNtpUs + spanUs);
+
+  hasSync = true;
+  lastNtpUs = ntpUs;
+  lastMonotonicUs = monotonicUs;
+  lastOffsetMs = hadSync ? (int32_t)(offsetUs / 1000) : 0;
+  if (!hadSync || spanUs < kMinSpanUs) return false;
+
+  const float samplePpm = (float)((double)offsetUs * 1e6 / (double)spanUs);
+  driftPpm = hasDrift ? (driftPpm + samplePpm) * 0.5f : samplePpm;
+  hasDrift = true;
+  return true;
+}
+
+time_t ClockDriftTracker::resyncIntervalSec(time_t fallbackSec, time_t minSec, time_t maxSec, uint32_t budgetMs) const {
+  if (!hasDrift) return fallbackSec;
+  const double ppm = fabs((double)driftPpm);
+  // budget [s] / rate error [s/s]
+  const double intervalSec = ppm > 0.0 ? ((double)budgetMs / 1000.0) / (ppm / 1e6) : (double)maxSec;
+  if (intervalSec <= (double)minSec) return minSec;
+  if (intervalSec >= (double)maxSec) return maxSec;
+  return (time_t)intervalSec;
+}
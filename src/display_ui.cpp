@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <algorithm>
 #include <ctype.h>
 #include <math.h>
 #include <stdint.h>
@@ -8,86 +9,489 @@
 #include <TFT_eSPI.h>
 
 #include "NotoSans_Bold.h"
+#include "boot_profile.h"
+#include "checksum_utils.h"
+#include "display_profile.h"
 #include "display_ui.h"
+#include "glyph_atlas.h"
 #include "logging_utils.h"
 
+// 0 = draw bars straight to the panel, 1 = whole chart in one sprite,
+// 2 = chart in small band sprites (falls back to direct if heap is short).
+#ifndef CONFIG_DISPLAY_CHART_MODE
+#define CONFIG_DISPLAY_CHART_MODE 2
+#endif
+
+// Times direct, sprite and banded chart drawing on every full redraw.
+#ifndef CONFIG_DISPLAY_FRAME_TIMING
+#define CONFIG_DISPLAY_FRAME_TIMING 0
+#endif
+
+// Pre-rasterize the price and currency glyphs at boot (0 = always use OFR).
+#ifndef CONFIG_DISPLAY_PRICE_ATLAS
+#define CONFIG_DISPLAY_PRICE_ATLAS 1
+#endif
+
+// Set by scripts/gen_price_atlas.py when it generated the atlases into flash.
+#ifndef CONFIG_DISPLAY_PRICE_ATLAS_PREBUILT
+#define CONFIG_DISPLAY_PRICE_ATLAS_PREBUILT 0
+#endif
+
+#if CONFIG_DISPLAY_PRICE_ATLAS && CONFIG_DISPLAY_PRICE_ATLAS_PREBUILT
+#include "price_atlas_data.h"
+#endif
+
+// Rolling chart window around the current slot, in whole hours. A negative
+// past value shows every loaded slot instead.
+#ifndef CONFIG_DISPLAY_WINDOW_PAST_HOURS
+#define CONFIG_DISPLAY_WINDOW_PAST_HOURS -1
+#endif
+
+#ifndef CONFIG_DISPLAY_WINDOW_AHEAD_HOURS
+#define CONFIG_DISPLAY_WINDOW_AHEAD_HOURS 36
+#endif
+
+// Count pixels and estimated bus bytes per primitive and log them per frame.
+#ifndef CONFIG_DISPLAY_BUS_STATS
+#define CONFIG_DISPLAY_BUS_STATS 0
+#endif
+
+// Time each draw stage with the CPU cycle counter and log p50/p99 per stage
+// every CONFIG_DISPLAY_STAGE_SUMMARY_FRAMES redraws.
+#ifndef CONFIG_DISPLAY_STAGE_TIMING
+#define CONFIG_DISPLAY_STAGE_TIMING 0
+#endif
+
+#ifndef CONFIG_DISPLAY_STAGE_SUMMARY_FRAMES
+#define CONFIG_DISPLAY_STAGE_SUMMARY_FRAMES 16
+#endif
+
+// TFT_eSPI only has DMA for ESP32 SPI panels, and pushImageDMA sends 16-bit
+// pixels which the ILI9488 does not accept over SPI (it needs 18-bit).
+#if defined(ESP32) && !defined(TFT_PARALLEL_8_BIT) && !defined(ILI9488_DRIVER)
+#define DISPLAY_CHART_DMA 1
+#else
+#define DISPLAY_CHART_DMA 0
+#endif
+
 namespace
 {
-  TFT_eSPI tft;
-  OpenFontRender ofr;
-  bool gOpenFontReady = false;
+#if CONFIG_DISPLAY_BUS_STATS
+  enum BusOp : uint8_t
+  {
+    kBusPixel = 0,
+    kBusHLine,
+    kBusVLine,
+    kBusRect,
+    kBusBlock,
+    kBusOpCount,
+  };
+
+  struct BusCounter
+  {
+    uint32_t calls = 0;
+    uint32_t pixels = 0;
+  };
+
+  // Panel wrapper that counts what each primitive actually puts on the bus,
+  // clipped like TFT_eSPI clips it. Bulk pushes (sprites, atlas rows) bypass
+  // the virtual primitives and are reported through countBlock(); glyphs of
+  // the built-in fonts are not seen.
+  class CountingTft : public TFT_eSPI
+  {
+  public:
+    BusCounter counters[kBusOpCount];
+
+    void drawPixel(int32_t x, int32_t y, uint32_t color) override
+    {
+      count(kBusPixel, x, y, 1, 1);
+      TFT_eSPI::drawPixel(x, y, color);
+    }
+
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) override
+    {
+      count(kBusHLine, x, y, w, 1);
+      TFT_eSPI::drawFastHLine(x, y, w, color);
+    }
+
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) override
+    {
+      count(kBusVLine, x, y, 1, h);
+      TFT_eSPI::drawFastVLine(x, y, h, color);
+    }
+
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override
+    {
+      count(kBusRect, x, y, w, h);
+      TFT_eSPI::fillRect(x, y, w, h, color);
+    }
+
+    // Shadows the library call so clipped strip repaints are counted correctly.
+    void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true)
+    {
+      TFT_eSPI::setViewport(x, y, w, h, vpDatum);
+      clip.x = x;
+      clip.y = y;
+      clip.w = w;
+      clip.h = h;
+      clip.datum = vpDatum;
+    }
+
+    void resetViewport()
+    {
+      TFT_eSPI::resetViewport();
+      clip = ScreenClip();
+    }
+
+    void countBlock(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+      count(kBusBlock, x, y, w, h);
+    }
+
+  private:
+    struct ScreenClip
+    {
+      int32_t x = 0;
+      int32_t y = 0;
+      int32_t w = -1;  // -1 = whole screen
+      int32_t h = -1;
+      bool datum = false;
+    };
+
+    ScreenClip clip;
+
+    void count(BusOp op, int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+      int32_t x0 = 0;
+      int32_t y0 = 0;
+      int32_t x1 = width();
+      int32_t y1 = height();
+      if (clip.w >= 0)
+      {
+        if (clip.datum)
+        {
+          x += clip.x;
+          y += clip.y;
+        }
+        x0 = max(x0, clip.x);
+        y0 = max(y0, clip.y);
+        x1 = min(x1, clip.x + clip.w);
+        y1 = min(y1, clip.y + clip.h);
+      }
+      const int32_t cw = min(x + w, x1) - max(x, x0);
+      const int32_t ch = min(y + h, y1) - max(y, y0);
+      if (cw <= 0 || ch <= 0)
+        return;
+      counters[op].calls++;
+      counters[op].pixels += (uint32_t)(cw * ch);
+    }
+  };
 
-  // Screen coordinate system:
-  // - X grows to the right
-  // - Y grows downward
-  //
-  // Quick tuning guide:
-  // - Increase X => move right, decrease X => move left
-  // - Increase Y => move down, decrease Y => move up
-  // - Increase W/H/font size => make larger
-
-#ifdef ILI9488_DRIVER
-  // 4.0" ILI9488 — 480x320 landscape
-  constexpr int kScreenCenterX        = 240;
-  constexpr int kPriceCenterY         = 55;
-  constexpr int kPriceFontSize        = 100;
-  constexpr int kCurrencyFontSize     = 40;
-  constexpr int kChartX               = 35;
-  constexpr int kChartY               = 125;
-  constexpr int kChartW               = 420;
-  constexpr int kChartH               = 185;
-  constexpr int kCurrentArrowHalfWidth = 3;
-  constexpr int kCurrentArrowHeight   = 10;
-  constexpr int kSourceLabelX         = 474;
-  constexpr int kErrorTitleY          = 93;
-  constexpr int kErrorDetailY         = 128;
-  constexpr int kWifiTitleY           = 28;
-  constexpr int kWifiStep1Y           = 77;
-  constexpr int kWifiApNameY          = 107;
-  constexpr int kWifiStep2Y           = 144;
-  constexpr int kWifiStep3Y           = 173;
-  constexpr int kWifiStep4aY          = 202;
-  constexpr int kWifiStep4bY          = 226;
-  constexpr int kWifiTimeoutY         = 258;
-  constexpr int kWifiToutTitleY       = 99;
-  constexpr int kWifiToutMsgY         = 144;
-  constexpr int kWifiToutRetryY       = 181;
+  using DisplayTft = CountingTft;
 #else
-  // 2.8" ILI9341 — 320x240 landscape
-  constexpr int kScreenCenterX        = 160;
-  constexpr int kPriceCenterY         = 44;
-  constexpr int kPriceFontSize        = 86;
-  constexpr int kCurrencyFontSize     = 34;
-  constexpr int kChartX               = 30;
-  constexpr int kChartY               = 106;
-  constexpr int kChartW               = 286;
-  constexpr int kChartH               = 126;
-  constexpr int kCurrentArrowHalfWidth = 3;
-  constexpr int kCurrentArrowHeight   = 9;
-  constexpr int kSourceLabelX         = 316;
-  constexpr int kErrorTitleY          = 70;
-  constexpr int kErrorDetailY         = 96;
-  constexpr int kWifiTitleY           = 20;
-  constexpr int kWifiStep1Y           = 58;
-  constexpr int kWifiApNameY          = 80;
-  constexpr int kWifiStep2Y           = 108;
-  constexpr int kWifiStep3Y           = 130;
-  constexpr int kWifiStep4aY          = 152;
-  constexpr int kWifiStep4bY          = 170;
-  constexpr int kWifiTimeoutY         = 194;
-  constexpr int kWifiToutTitleY       = 74;
-  constexpr int kWifiToutMsgY         = 108;
-  constexpr int kWifiToutRetryY       = 136;
+  using DisplayTft = TFT_eSPI;
 #endif
 
+  DisplayTft tft;
+  OpenFontRender ofr;
+  bool gOpenFontReady = false;
+  TFT_eSprite gBandSpriteA(&tft);
+  TFT_eSprite gBandSpriteB(&tft);
+  TFT_eSprite *const gBandSprites[2] = {&gBandSpriteA, &gBandSpriteB};
+  bool gBandSpritesAttempted = false;
+  bool gBandSpritesReady = false;
+
+  // TFT_WIDTH x TFT_HEIGHT is the panel in portrait; the UI runs in landscape.
+  using ActiveProfile = DisplayProfileFor<TFT_HEIGHT, TFT_WIDTH>::type;
+
   constexpr int kPriceCurrencyGapPx   = 8;
-  constexpr int kDayLabelY            = kChartY - 20;
-  constexpr int kAxisLabelX           = kChartX - 8;
   constexpr uint16_t kCurrentArrowColor = TFT_WHITE;
   constexpr int kYAxisFontSize        = 2;
   constexpr int kTopXAxisFontSize     = 2;
   constexpr int kSourceLabelY         = 2;
   constexpr uint16_t kAverageLineColor = TFT_CYAN;
+  constexpr int kPriceBoxPadPx        = 6;
+  // Two bands of kChartW x 16 px: ~27 KB on the ILI9488, ~18 KB on the ILI9341.
+  constexpr int kChartBandRows        = 16;
+  // Narrower bars alternate between 1 and 2 px; the chart decimates instead.
+  constexpr int kMinBarPx             = 2;
+
+  enum class ChartRenderMode : uint8_t
+  {
+    Direct = 0,
+    Sprite = 1,
+    Banded = 2,
+  };
+
+  constexpr ChartRenderMode kChartRenderMode = (ChartRenderMode)CONFIG_DISPLAY_CHART_MODE;
+
+  struct ScreenRect
+  {
+    int x = 0;
+    int y = 0;
+    int w = 0;
+    int h = 0;
+  };
+
+  // Retained model of what is currently on the panel. Anything that changes
+  // the chart layout (data, range, average, banner) forces a full redraw;
+  // price text and current-slot changes are repainted in place.
+  struct FrameModel
+  {
+    bool valid = false;
+    uint32_t chartSignature = 0;
+    int windowStart = 0;
+    int currentIndex = -1;
+    char priceText[16] = {0};
+    char currencyText[8] = {0};
+    uint16_t priceColor = 0;
+    ScreenRect priceBox;
+  };
+
+  FrameModel gFrame;
+
+#if CONFIG_DISPLAY_BUS_STATS
+  // 18-bit colour over SPI on the ILI9488, 16-bit everywhere else.
+#if defined(ILI9488_DRIVER) && !defined(TFT_PARALLEL_8_BIT)
+  constexpr uint32_t kBusBytesPerPixel = 3;
+#else
+  constexpr uint32_t kBusBytesPerPixel = 2;
+#endif
+  // CASET + RASET + RAMWR with their parameters.
+  constexpr uint32_t kBusWindowBytes = 11;
+#endif
+
+  void noteBlockPush(int x, int y, int w, int h)
+  {
+#if CONFIG_DISPLAY_BUS_STATS
+    tft.countBlock(x, y, w, h);
+#else
+    (void)x;
+    (void)y;
+    (void)w;
+    (void)h;
+#endif
+  }
+
+#if CONFIG_DISPLAY_BUS_STATS || CONFIG_DISPLAY_STAGE_TIMING
+  // Estimated bytes sent to the panel since the last logBusStats().
+  uint32_t busBytesTotal()
+  {
+#if CONFIG_DISPLAY_BUS_STATS
+    uint32_t calls = 0;
+    uint32_t pixels = 0;
+    for (const BusCounter &counter : tft.counters)
+    {
+      calls += counter.calls;
+      pixels += counter.pixels;
+    }
+    return (pixels * kBusBytesPerPixel) + (calls * kBusWindowBytes);
+#else
+    return 0;
+#endif
+  }
+#endif
+
+  void logBusStats(const char *frame)
+  {
+#if CONFIG_DISPLAY_BUS_STATS
+    const BusCounter *c = tft.counters;
+    logf(
+        "Display bus %s: pixel=%lu/%lu hline=%lu/%lu vline=%lu/%lu rect=%lu/%lu block=%lu/%lu bytes=%lu",
+        frame,
+        (unsigned long)c[kBusPixel].calls,
+        (unsigned long)c[kBusPixel].pixels,
+        (unsigned long)c[kBusHLine].calls,
+        (unsigned long)c[kBusHLine].pixels,
+        (unsigned long)c[kBusVLine].calls,
+        (unsigned long)c[kBusVLine].pixels,
+        (unsigned long)c[kBusRect].calls,
+        (unsigned long)c[kBusRect].pixels,
+        (unsigned long)c[kBusBlock].calls,
+        (unsigned long)c[kBusBlock].pixels,
+        (unsigned long)busBytesTotal());
+    for (BusCounter &counter : tft.counters)
+    {
+      counter = BusCounter();
+    }
+#else
+    (void)frame;
+#endif
+  }
+
+  enum DrawStage : uint8_t
+  {
+    kStageClear = 0,
+    kStageText,
+    kStageAxes,
+    kStageBars,
+    kStageTicks,
+    kStageAverage,
+    kStageMarker,
+    kStagePush,
+    kStageTotal,
+    kStageCount,
+  };
+
+#if CONFIG_DISPLAY_STAGE_TIMING
+  constexpr const char *kStageNames[kStageCount] = {
+      "clear", "text", "axes", "bars", "ticks", "average", "marker", "push", "total"};
+  constexpr size_t kStageSampleCount = 64;
+
+  // Per-stage cycles and bus bytes of the last kStageSampleCount frames in
+  // which the stage ran. A stage entered several times in one frame (band
+  // sprites, partial column repaints) counts as one sample.
+  struct StageStats
+  {
+    uint32_t frameCycles = 0;
+    uint32_t frameBytes = 0;
+    bool ranThisFrame = false;
+    uint32_t cycles[kStageSampleCount] = {0};
+    uint32_t bytes[kStageSampleCount] = {0};
+    size_t count = 0;
+    size_t next = 0;
+  };
+
+  StageStats gStages[kStageCount];
+  bool gStageFrameActive = false;
+  uint32_t gStageFrameStart = 0;
+  uint32_t gStageFrames = 0;
+
+  void noteStage(DrawStage stage, uint32_t cycles, uint32_t bytes)
+  {
+    // Clock refreshes between redraws are not part of any frame.
+    if (!gStageFrameActive)
+      return;
+    StageStats &stats = gStages[stage];
+    stats.frameCycles += cycles;
+    stats.frameBytes += bytes;
+    stats.ranThisFrame = true;
+  }
+
+  uint32_t percentile(const uint32_t *samples, size_t count, unsigned pct)
+  {
+    uint32_t sorted[kStageSampleCount];
+    std::copy(samples, samples + count, sorted);
+    std::sort(sorted, sorted + count);
+    return sorted[((count - 1) * pct + 50) / 100];
+  }
+
+  uint32_t cyclesToUs(uint32_t cycles)
+  {
+    return cycles / max((uint32_t)1, (uint32_t)ESP.getCpuFreqMHz());
+  }
+
+  void logStageSummary()
+  {
+    for (uint8_t i = 0; i < kStageCount; ++i)
+    {
+      const StageStats &stats = gStages[i];
+      if (stats.count == 0)
+        continue;
+      logf(
+          "Display stage %s: n=%u p50=%luus p99=%luus bytes p50=%lu p99=%lu",
+          kStageNames[i],
+          (unsigned)stats.count,
+          (unsigned long)cyclesToUs(percentile(stats.cycles, stats.count, 50)),
+          (unsigned long)cyclesToUs(percentile(stats.cycles, stats.count, 99)),
+          (unsigned long)percentile(stats.bytes, stats.count, 50),
+          (unsigned long)percentile(stats.bytes, stats.count, 99));
+    }
+  }
+
+  void beginStageFrame()
+  {
+    gStageFrameActive = true;
+    gStageFrameStart = ESP.getCycleCount();
+  }
+
+  void endStageFrame()
+  {
+    uint32_t frameBytes = 0;
+    for (const StageStats &stats : gStages)
+    {
+      frameBytes += stats.frameBytes;
+    }
+    // Bus counters are reset by logBusStats() before this runs, so the
+    // frame's bytes are the sum of its stages.
+    noteStage(kStageTotal, ESP.getCycleCount() - gStageFrameStart, frameBytes);
+    gStageFrameActive = false;
+
+    for (StageStats &stats : gStages)
+    {
+      if (!stats.ranThisFrame)
+        continue;
+      stats.cycles[stats.next] = stats.frameCycles;
+      stats.bytes[stats.next] = stats.frameBytes;
+      stats.next = (stats.next + 1) % kStageSampleCount;
+      stats.count = min(stats.count + 1, kStageSampleCount);
+      stats.frameCycles = 0;
+      stats.frameBytes = 0;
+      stats.ranThisFrame = false;
+    }
+
+    if (++gStageFrames % CONFIG_DISPLAY_STAGE_SUMMARY_FRAMES == 0)
+    {
+      logStageSummary();
+    }
+  }
+
+  // Adds the cycles and bus bytes spent in its lifetime to `stage`.
+  class StageScope
+  {
+  public:
+    explicit StageScope(DrawStage stage)
+        : stage(stage), startCycles(ESP.getCycleCount()), startBytes(busBytesTotal())
+    {
+    }
+
+    ~StageScope()
+    {
+      noteStage(stage, ESP.getCycleCount() - startCycles, busBytesTotal() - startBytes);
+    }
+
+    StageScope(const StageScope &) = delete;
+    StageScope &operator=(const StageScope &) = delete;
+
+  private:
+    DrawStage stage;
+    uint32_t startCycles;
+    uint32_t startBytes;
+  };
+
+  // One displayDrawPrices() call, including its early returns.
+  class StageFrame
+  {
+  public:
+    StageFrame()
+    {
+      beginStageFrame();
+    }
+
+    ~StageFrame()
+    {
+      endStageFrame();
+    }
+  };
+#else
+  class StageScope
+  {
+  public:
+    explicit StageScope(DrawStage) {}
+  };
+
+  class StageFrame
+  {
+  public:
+    StageFrame() {}
+  };
+#endif
+
+  // Price glyphs and the letters of the currencies offered in the portal.
+  constexpr char kPriceAtlasGlyphs[]    = "0123456789.-";
+  constexpr char kCurrencyAtlasGlyphs[] = "DEKNORSU";
+  GlyphAtlas gPriceAtlas;
+  GlyphAtlas gCurrencyAtlas;
 
   void formatPriceValue(float value, char *out, size_t outSize)
   {
@@ -157,38 +561,72 @@ namespace
 #endif
   }
 
-  void drawPriceText(float priceValue, const String &currency, uint16_t color)
+  // Lays price and currency out exactly like drawPriceTextFont() but blits
+  // them from the pre-rasterized atlases. False when a glyph is missing.
+  template <typename Profile>
+  bool drawPriceTextAtlas(const char *priceText, const char *currencyText, uint16_t color, ScreenRect &box)
   {
-    char priceText[16];
-    char currencyText[8];
-    formatPriceValue(priceValue, priceText, sizeof(priceText));
-    formatCurrencyLabel(currency, currencyText, sizeof(currencyText));
+    const int priceWidth = glyphAtlasTextWidth(gPriceAtlas, priceText);
+    const int currencyWidth = glyphAtlasTextWidth(gCurrencyAtlas, currencyText);
+    if (priceWidth <= 0 || currencyWidth <= 0)
+      return false;
+
+    const int priceHeight = gPriceAtlas.height;
+    const int currencyHeight = gCurrencyAtlas.height;
+    const int totalWidth = priceWidth + kPriceCurrencyGapPx + currencyWidth;
+    const int startX = Profile::kScreenCenterX - (totalWidth / 2);
+    const int priceTop = Profile::kPriceCenterY - (priceHeight / 2);
+    const int currencyTop = Profile::kPriceCenterY + ((priceHeight - currencyHeight) / 2) - (currencyHeight / 2);
+
+    const int currencyX = startX + priceWidth + kPriceCurrencyGapPx;
+    if (!glyphAtlasDraw(gPriceAtlas, tft, priceText, startX, priceTop, color, TFT_BLACK))
+      return false;
+    noteBlockPush(startX, priceTop, priceWidth, priceHeight);
+    if (!glyphAtlasDraw(gCurrencyAtlas, tft, currencyText, currencyX, currencyTop, color, TFT_BLACK))
+      return false;
+    noteBlockPush(currencyX, currencyTop, currencyWidth, currencyHeight);
+
+    box.x = startX - kPriceBoxPadPx;
+    box.y = priceTop - kPriceBoxPadPx;
+    box.w = totalWidth + (2 * kPriceBoxPadPx);
+    box.h = priceHeight + (2 * kPriceBoxPadPx);
+    return true;
+  }
 
+  template <typename Profile>
+  ScreenRect drawPriceTextFont(const char *priceText, const char *currencyText, uint16_t color)
+  {
+    ScreenRect box;
     if (gOpenFontReady)
     {
       ofr.setFontColor(color, TFT_BLACK);
       ofr.setAlignment(Align::MiddleLeft);
 
-      ofr.setFontSize(kPriceFontSize);
+      ofr.setFontSize(Profile::kPriceFontSize);
       const int priceWidth = (int)ofr.getTextWidth("%s", priceText);
       const int priceHeight = (int)ofr.getTextHeight("%s", priceText);
-      ofr.setFontSize(kCurrencyFontSize);
+      ofr.setFontSize(Profile::kCurrencyFontSize);
       const int currencyWidth = (int)ofr.getTextWidth("%s", currencyText);
       const int currencyHeight = (int)ofr.getTextHeight("%s", currencyText);
 
       const int totalWidth = priceWidth + kPriceCurrencyGapPx + currencyWidth;
-      const int startX = kScreenCenterX - (totalWidth / 2);
-      const int priceY = kPriceCenterY;
-      const int currencyY = kPriceCenterY + ((priceHeight - currencyHeight) / 2);
+      const int startX = Profile::kScreenCenterX - (totalWidth / 2);
+      const int priceY = Profile::kPriceCenterY;
+      const int currencyY = Profile::kPriceCenterY + ((priceHeight - currencyHeight) / 2);
 
-      ofr.setFontSize(kPriceFontSize);
+      ofr.setFontSize(Profile::kPriceFontSize);
       ofr.setCursor(startX, priceY);
       ofr.printf("%s", priceText);
 
-      ofr.setFontSize(kCurrencyFontSize);
+      ofr.setFontSize(Profile::kCurrencyFontSize);
       ofr.setCursor(startX + priceWidth + kPriceCurrencyGapPx, currencyY);
       ofr.printf("%s", currencyText);
-      return;
+
+      box.x = startX - kPriceBoxPadPx;
+      box.y = priceY - (priceHeight / 2) - kPriceBoxPadPx;
+      box.w = totalWidth + (2 * kPriceBoxPadPx);
+      box.h = priceHeight + (2 * kPriceBoxPadPx);
+      return box;
     }
 
     // Fallback if smooth font is unavailable.
@@ -207,8 +645,8 @@ namespace
     const int currencyHeight = tft.fontHeight();
 
     const int totalWidth = priceWidth + kPriceCurrencyGapPx + currencyWidth;
-    const int startX = kScreenCenterX - (totalWidth / 2);
-    const int priceY = kPriceCenterY - (priceHeight / 2);
+    const int startX = Profile::kScreenCenterX - (totalWidth / 2);
+    const int priceY = Profile::kPriceCenterY - (priceHeight / 2);
     const int currencyY = priceY + (priceHeight - currencyHeight);
 
     tft.setTextFont(4);
@@ -221,6 +659,78 @@ namespace
 
     tft.setTextSize(1);
     tft.setTextDatum(TL_DATUM);
+
+    box.x = startX - kPriceBoxPadPx;
+    box.y = priceY - kPriceBoxPadPx;
+    box.w = totalWidth + (2 * kPriceBoxPadPx);
+    box.h = priceHeight + (2 * kPriceBoxPadPx);
+    return box;
+  }
+
+  // Returns the screen area covered by the text so it can be cleared on the next partial update.
+  template <typename Profile>
+  ScreenRect drawPriceText(const char *priceText, const char *currencyText, uint16_t color)
+  {
+    StageScope stage(kStageText);
+    ScreenRect box;
+#if CONFIG_DISPLAY_FRAME_TIMING
+    // Draw through the font first so both paths are timed on the same text.
+    uint32_t start = micros();
+    box = drawPriceTextFont<Profile>(priceText, currencyText, color);
+    const uint32_t fontUs = micros() - start;
+    start = micros();
+    const bool atlasOk = drawPriceTextAtlas<Profile>(priceText, currencyText, color, box);
+    const uint32_t atlasUs = micros() - start;
+    if (atlasOk)
+    {
+      logf("Display price text: font=%luus atlas=%luus", (unsigned long)fontUs, (unsigned long)atlasUs);
+    }
+    else
+    {
+      logf("Display price text: font=%luus atlas=n/a", (unsigned long)fontUs);
+    }
+#else
+    if (!drawPriceTextAtlas<Profile>(priceText, currencyText, color, box))
+    {
+      box = drawPriceTextFont<Profile>(priceText, currencyText, color);
+    }
+#endif
+    return box;
+  }
+
+  template <typename Profile>
+  void buildPriceAtlases()
+  {
+#if CONFIG_DISPLAY_PRICE_ATLAS
+#if CONFIG_DISPLAY_PRICE_ATLAS_PREBUILT
+    const size_t prebuiltCount = sizeof(kPrebuiltPriceAtlases) / sizeof(kPrebuiltPriceAtlases[0]);
+    if (glyphAtlasAttach(gPriceAtlas, kPrebuiltPriceAtlases, prebuiltCount, kPriceAtlasGlyphs,
+                         Profile::kPriceFontSize) &&
+        glyphAtlasAttach(gCurrencyAtlas, kPrebuiltPriceAtlases, prebuiltCount, kCurrencyAtlasGlyphs,
+                         Profile::kCurrencyFontSize))
+    {
+      logf("Display glyph atlas: prebuilt bytes=%u", (unsigned)(gPriceAtlas.bytes + gCurrencyAtlas.bytes));
+      return;
+    }
+#endif
+    // No build-time atlas for this profile: rasterize through OFR.
+    if (!gOpenFontReady)
+      return;
+
+    const uint32_t start = millis();
+    const bool ok = glyphAtlasBuild(gPriceAtlas, ofr, tft, kPriceAtlasGlyphs, '0', Profile::kPriceFontSize) &&
+                    glyphAtlasBuild(gCurrencyAtlas, ofr, tft, kCurrencyAtlasGlyphs, 'E', Profile::kCurrencyFontSize);
+    if (!ok)
+    {
+      glyphAtlasFree(gPriceAtlas);
+      glyphAtlasFree(gCurrencyAtlas);
+    }
+    logf(
+        "Display glyph atlas: %s bytes=%u build=%lums",
+        ok ? "ready" : "failed",
+        (unsigned)(gPriceAtlas.bytes + gCurrencyAtlas.bytes),
+        (unsigned long)(millis() - start));
+#endif
   }
 
   struct ChartRange
@@ -230,16 +740,6 @@ namespace
     float span = 1.0f;
   };
 
-  struct Rgb
-  {
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
-
-    Rgb() : r(0), g(0), b(0) {}
-    Rgb(uint8_t rr, uint8_t gg, uint8_t bb) : r(rr), g(gg), b(bb) {}
-  };
-
   struct LevelBand
   {
     bool has = false;
@@ -247,13 +747,53 @@ namespace
     float maxPrice = 0.0f;
   };
 
-  static const Rgb kLevelColors[] = {
-      Rgb(170, 255, 170), // VERY_CHEAP / LOW
-      Rgb(96, 210, 110),  // CHEAP
-      Rgb(245, 190, 70),  // NORMAL
-      Rgb(185, 55, 35),   // EXPENSIVE / HIGH
-      Rgb(100, 0, 0),     // VERY_EXPENSIVE
+  // Level hues, light green -> dark red, as stops of one gradient.
+  constexpr uint8_t kGradientStops[5][3] = {
+      {170, 255, 170}, // VERY_CHEAP / LOW
+      {96, 210, 110},  // CHEAP
+      {245, 190, 70},  // NORMAL
+      {185, 55, 35},   // EXPENSIVE / HIGH
+      {100, 0, 0},     // VERY_EXPENSIVE
   };
+  constexpr int kGradientSize = 256;
+  // Stop k sits at LUT index k * 255 / 4.
+  constexpr float kGradientStopSpacing = (kGradientSize - 1) / 4.0f;
+
+  constexpr int gradientSegment(int i)
+  {
+    return ((i * 4) / 255) < 3 ? ((i * 4) / 255) : 3;
+  }
+
+  constexpr int gradientLerp(int a, int b, int num)
+  {
+    return a + ((((b - a) * num) + ((b >= a) ? 127 : -127)) / 255);
+  }
+
+  constexpr int gradientChannel(int i, int c)
+  {
+    return gradientLerp(
+        kGradientStops[gradientSegment(i)][c],
+        kGradientStops[gradientSegment(i) + 1][c],
+        (i * 4) - (gradientSegment(i) * 255));
+  }
+
+  // Same packing as TFT_eSPI::color565().
+  constexpr uint16_t gradient565(int i)
+  {
+    return (uint16_t)(((gradientChannel(i, 0) & 0xF8) << 8) | ((gradientChannel(i, 1) & 0xFC) << 3) | (gradientChannel(i, 2) >> 3));
+  }
+
+#define GRADIENT_4(i) gradient565(i), gradient565((i) + 1), gradient565((i) + 2), gradient565((i) + 3)
+#define GRADIENT_16(i) GRADIENT_4(i), GRADIENT_4((i) + 4), GRADIENT_4((i) + 8), GRADIENT_4((i) + 12)
+#define GRADIENT_64(i) GRADIENT_16(i), GRADIENT_16((i) + 16), GRADIENT_16((i) + 32), GRADIENT_16((i) + 48)
+  constexpr uint16_t kGradientLut[kGradientSize] = {
+      GRADIENT_64(0), GRADIENT_64(64), GRADIENT_64(128), GRADIENT_64(192)};
+#undef GRADIENT_64
+#undef GRADIENT_16
+#undef GRADIENT_4
+
+  static_assert(kGradientLut[0] == 0xAFF5, "first stop must be VERY_CHEAP green");
+  static_assert(kGradientLut[kGradientSize - 1] == 0x6000, "last stop must be VERY_EXPENSIVE red");
 
   int levelRank(const String &level)
   {
@@ -270,35 +810,6 @@ namespace
     return -1;
   }
 
-  uint8_t lerpU8(uint8_t a, uint8_t b, float t)
-  {
-    if (t <= 0.0f)
-      return a;
-    if (t >= 1.0f)
-      return b;
-    const float af = (float)a;
-    const float bf = (float)b;
-    int value = (int)lroundf(af + ((bf - af) * t));
-    if (value < 0)
-      value = 0;
-    if (value > 255)
-      value = 255;
-    return (uint8_t)value;
-  }
-
-  uint16_t lerpRgb565(const Rgb &from, const Rgb &to, float t)
-  {
-    const uint8_t r = lerpU8(from.r, to.r, t);
-    const uint8_t g = lerpU8(from.g, to.g, t);
-    const uint8_t b = lerpU8(from.b, to.b, t);
-    return tft.color565(r, g, b);
-  }
-
-  Rgb lerpRgb(const Rgb &from, const Rgb &to, float t)
-  {
-    return Rgb(lerpU8(from.r, to.r, t), lerpU8(from.g, to.g, t), lerpU8(from.b, to.b, t));
-  }
-
   float clamp01(float v)
   {
     if (v < 0.0f)
@@ -331,58 +842,57 @@ namespace
     }
   }
 
+  uint16_t gradientColor(float position)
+  {
+    const int index = (int)lroundf(position);
+    return kGradientLut[max(0, min(kGradientSize - 1, index))];
+  }
+
   uint16_t barGradientColor(const PricePoint &point, const LevelBand bands[5], const ChartRange &range)
   {
     const int rank = levelRank(point.level);
     if (rank < 0 || rank > 4 || !bands[rank].has)
     {
       // Fallback to global gradient if level is unknown.
-      const float t = clamp01((point.price - range.minPrice) / range.span);
-      constexpr int kSegments = (int)(sizeof(kLevelColors) / sizeof(kLevelColors[0])) - 1;
-      const float scaled = t * (float)kSegments;
-      int idx = (int)floorf(scaled);
-      if (idx < 0)
-        idx = 0;
-      if (idx >= kSegments)
-        idx = kSegments - 1;
-      const float localT = scaled - (float)idx;
-      return lerpRgb565(kLevelColors[idx], kLevelColors[idx + 1], localT);
+      return gradientColor(clamp01((point.price - range.minPrice) / range.span) * (kGradientSize - 1));
     }
 
     const LevelBand &band = bands[rank];
+    const float anchor = rank * kGradientStopSpacing;
     const float span = band.maxPrice - band.minPrice;
     if (span < 0.001f)
-      return tft.color565(kLevelColors[rank].r, kLevelColors[rank].g, kLevelColors[rank].b);
+      return gradientColor(anchor);
     const float t = clamp01((point.price - band.minPrice) / span);
 
     // Keep color anchored in current level hue.
     // Only shift toward neighboring level hues when those levels are present.
-    Rgb lowSide = kLevelColors[rank];
-    Rgb highSide = kLevelColors[rank];
     constexpr float kLowerShift = 0.70f;
     constexpr float kHigherShift = 0.45f;
+    float low = anchor;
+    float high = anchor;
 
     if (rank > 0 && bands[rank - 1].has)
     {
-      lowSide = lerpRgb(kLevelColors[rank], kLevelColors[rank - 1], kLowerShift);
+      low -= kLowerShift * kGradientStopSpacing;
     }
     if (rank < 4 && bands[rank + 1].has)
     {
-      highSide = lerpRgb(kLevelColors[rank], kLevelColors[rank + 1], kHigherShift);
+      high += kHigherShift * kGradientStopSpacing;
     }
 
-    return lerpRgb565(lowSide, highSide, t);
+    return gradientColor(low + ((high - low) * t));
   }
 
-  ChartRange computeChartRange(const PriceState &state)
+  // Range over points [first, last).
+  ChartRange computeChartRange(const PriceState &state, int first, int last)
   {
     ChartRange range;
-    if (state.count == 0)
+    if (last <= first)
       return range;
 
-    range.minPrice = state.points[0].price;
-    range.maxPrice = state.points[0].price;
-    for (size_t i = 1; i < state.count; ++i)
+    range.minPrice = state.points[first].price;
+    range.maxPrice = state.points[first].price;
+    for (int i = first + 1; i < last; ++i)
     {
       if (state.points[i].price < range.minPrice)
         range.minPrice = state.points[i].price;
@@ -401,19 +911,186 @@ namespace
     return xAxisY - (int)(normalized * drawableH);
   }
 
+  // Slots the chart spans: everything loaded, or a fixed-width window that
+  // keeps the current slot at the same x and scrolls as it advances.
+  // `start` may be negative when fewer past slots are loaded than shown.
+  struct ChartWindow
+  {
+    int start = 0;
+    int slots = 0;
+  };
+
+  ChartWindow computeChartWindow(const PriceState &state)
+  {
+    ChartWindow window;
+    window.slots = (int)state.count;
+#if CONFIG_DISPLAY_WINDOW_PAST_HOURS >= 0
+    if (state.currentIndex < 0 || state.currentIndex >= (int)state.count)
+      return window;
+
+    const int resolution = max(1, (int)state.resolutionMinutes);
+    const int past = (CONFIG_DISPLAY_WINDOW_PAST_HOURS * 60) / resolution;
+    const int ahead = (CONFIG_DISPLAY_WINDOW_AHEAD_HOURS * 60) / resolution;
+    window.start = state.currentIndex - past;
+    window.slots = past + ahead + 1;
+#endif
+    return window;
+  }
+
+  template <typename Profile>
+  void barSpan(int index, int pointCount, int &x0, int &w)
+  {
+    using Layout = DisplayLayout<Profile>;
+    x0 = Layout::slotX(index, pointCount);
+    const int x1 = Layout::slotX(index + 1, pointCount);
+    w = max(1, x1 - x0);
+  }
+  // Per-column geometry and colours, rebuilt only when the chart data changes.
+  // Full redraws, band sprites and partial repaints only index these tables.
+  // A column is one bar, or a kMinBarPx wide strip when bars would be
+  // narrower; those columns are min/max envelopes of the points they cover.
+  struct ChartModel
+  {
+    bool valid = false;
+    uint32_t signature = 0;
+    int windowStart = 0;
+    ChartRange range;
+    int count = 0;       // data points
+    int first = 0;       // visible points are [first, last)
+    int last = 0;
+    int columnCount = 0; // drawn columns
+    bool decimated = false;
+    bool hasAverage = false;
+    int16_t averageY = 0;
+    int16_t columnX[kMaxPoints];
+    int16_t columnW[kMaxPoints];
+    int16_t columnTopY[kMaxPoints];      // highest price in the column
+    int16_t columnLowY[kMaxPoints];      // lowest price; equals top for plain bars
+    uint16_t columnTopColor[kMaxPoints]; // colour of the highest point
+    uint16_t columnLowColor[kMaxPoints]; // colour of the lowest point, fills below columnLowY
+    int16_t pointColumn[kMaxPoints];     // -1 outside the window
+    uint16_t pointColor[kMaxPoints];
+    uint8_t tickLen[kMaxPoints]; // 0 = no hour tick at this point
+  };
+
+  ChartModel gChart;
+
+  uint8_t hourTickLength(const PricePoint &p)
+  {
+    if (p.startsAt.length() < 16)
+      return 0;
+    const char *s = p.startsAt.c_str();
+    if (s[10] != 'T')
+      return 0;
+
+    const int hour   = (s[11] - '0') * 10 + (s[12] - '0');
+    const int minute = (s[14] - '0') * 10 + (s[15] - '0');
+    if (minute != 0)
+      return 0;
+    // Tall tick every 6 hours, short tick on other whole hours.
+    return (hour % 6 == 0) ? 8 : 4;
+  }
+
+  // One linear pass over the points; with decimation every point folds into
+  // the kMinBarPx column it falls on, so draw cost follows kChartW, not count.
+  template <typename Profile>
+  void buildChartModel(const PriceState &state, uint32_t signature, const ChartWindow &window)
+  {
+    using Layout = DisplayLayout<Profile>;
+    ChartModel &chart = gChart;
+    chart.count = (int)state.count;
+    chart.first = max(0, window.start);
+    chart.last = min(chart.count, window.start + window.slots);
+    // The scale follows the visible slots; level hues stay tied to all loaded data.
+    chart.range = computeChartRange(state, chart.first, chart.last);
+    LevelBand bands[5];
+    computeLevelBands(state, bands);
+
+    chart.decimated = window.slots * kMinBarPx > Profile::kChartW;
+    chart.columnCount = 0;
+    for (int i = 0; i < chart.count; ++i)
+    {
+      chart.pointColumn[i] = -1;
+    }
+    for (int i = chart.first; i < chart.last; ++i)
+    {
+      const PricePoint &p = state.points[i];
+      const int y = priceToY(p.price, chart.range, Layout::kChartAxisY, Layout::kChartDrawableH);
+      const uint16_t color = barGradientColor(p, bands, chart.range);
+      chart.pointColor[i] = color;
+      chart.tickLen[i] = hourTickLength(p);
+
+      const int slot = i - window.start;
+      int x = 0;
+      int w = 0;
+      if (chart.decimated)
+      {
+        // Fixed columns from the chart's left edge; the last may be narrower.
+        x = Profile::kChartX + (((Layout::slotX(slot, window.slots) - Profile::kChartX) / kMinBarPx) * kMinBarPx);
+        w = min(kMinBarPx, Profile::kChartX + Profile::kChartW - x);
+      }
+      else
+      {
+        barSpan<Profile>(slot, window.slots, x, w);
+      }
+
+      const int last = chart.columnCount - 1;
+      if (last >= 0 && chart.columnX[last] == x)
+      {
+        // Same column as the previous point: widen the envelope.
+        if (y < chart.columnTopY[last])
+        {
+          chart.columnTopY[last] = (int16_t)y;
+          chart.columnTopColor[last] = color;
+        }
+        if (y > chart.columnLowY[last])
+        {
+          chart.columnLowY[last] = (int16_t)y;
+          chart.columnLowColor[last] = color;
+        }
+        chart.pointColumn[i] = (int16_t)last;
+        continue;
+      }
+
+      const int column = chart.columnCount++;
+      chart.columnX[column] = (int16_t)x;
+      chart.columnW[column] = (int16_t)w;
+      chart.columnTopY[column] = (int16_t)y;
+      chart.columnLowY[column] = (int16_t)y;
+      chart.columnTopColor[column] = color;
+      chart.columnLowColor[column] = color;
+      chart.pointColumn[i] = (int16_t)column;
+    }
+
+    chart.hasAverage = state.hasRunningAverage;
+    if (chart.hasAverage)
+    {
+      const int yAvg = priceToY(state.runningAverage, chart.range, Layout::kChartAxisY, Layout::kChartDrawableH);
+      chart.averageY = (int16_t)max(Profile::kChartY, min(Layout::kChartAxisY, yAvg));
+    }
+
+    chart.signature = signature;
+    chart.windowStart = window.start;
+    chart.valid = true;
+  }
+
+
+  template <typename Profile>
   void drawErrorScreen(const String &errorText)
   {
     tft.setTextDatum(MC_DATUM);
     tft.setTextColor(TFT_RED, TFT_BLACK);
     tft.setTextFont(4);
-    tft.drawString("Fetch failed", kScreenCenterX, kErrorTitleY);
+    tft.drawString("Fetch failed", Profile::kScreenCenterX, Profile::kErrorTitleY);
     tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
     tft.setTextFont(2);
-    tft.drawString(errorText, kScreenCenterX, kErrorDetailY);
+    tft.drawString(errorText, Profile::kScreenCenterX, Profile::kErrorDetailY);
   }
 
+  template <typename Profile>
   void drawClockLabel()
   {
+    StageScope stage(kStageText);
     char text[6] = "--:--";
     const time_t now = time(nullptr);
     if (now > 1700000000)
@@ -428,12 +1105,15 @@ namespace
     tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
     tft.setTextFont(4);
     tft.setTextDatum(TR_DATUM);
-    tft.drawString(text, kSourceLabelX, kSourceLabelY);
+    tft.drawString(text, Profile::kSourceLabelX, kSourceLabelY);
     tft.setTextDatum(TL_DATUM);
   }
 
+  template <typename Profile>
   void drawYAxis(const ChartRange &range, int xAxisY, int drawableH)
   {
+    using Layout = DisplayLayout<Profile>;
+    StageScope stage(kStageAxes);
     tft.setTextFont(kYAxisFontSize);
 
     auto drawAxisValueLabel = [&](float value, int y)
@@ -442,7 +1122,7 @@ namespace
       snprintf(label, sizeof(label), "%.1f", value);
       tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
       tft.setTextDatum(MR_DATUM);
-      tft.drawString(label, kChartX - 3, y);
+      tft.drawString(label, Profile::kChartX - 3, y);
     };
 
     const int yTop = xAxisY - drawableH;
@@ -456,7 +1136,7 @@ namespace
       const int yTick = priceToY(tick, range, xAxisY, drawableH);
       const bool isWhole = fabsf(tick - roundf(tick)) < 0.01f;
       const int tickLen = isWhole ? 6 : 3;
-      tft.drawFastHLine(kChartX - tickLen, yTick, tickLen, TFT_DARKGREY);
+      tft.drawFastHLine(Profile::kChartX - tickLen, yTick, tickLen, TFT_DARKGREY);
 
       if (!isWhole)
         continue;
@@ -467,291 +1147,773 @@ namespace
       snprintf(label, sizeof(label), "%d", (int)roundf(tick));
       tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
       tft.setTextDatum(MR_DATUM);
-      tft.drawString(label, kAxisLabelX, yTick);
+      tft.drawString(label, Layout::kAxisLabelX, yTick);
     }
 
-    tft.drawFastHLine(kChartX - 8, yBottom, 8, TFT_DARKGREY);
-    tft.drawFastHLine(kChartX - 8, yTop, 8, TFT_DARKGREY);
+    tft.drawFastHLine(Profile::kChartX - 8, yBottom, 8, TFT_DARKGREY);
+    tft.drawFastHLine(Profile::kChartX - 8, yTop, 8, TFT_DARKGREY);
     drawAxisValueLabel(range.minPrice, yBottom);
     drawAxisValueLabel(range.maxPrice, yTop);
     tft.setTextDatum(TL_DATUM);
   }
 
-  void drawRunningAverage(const PriceState &state, const ChartRange &range, int xAxisY, int drawableH)
+  // Chart interior target: the panel itself (origin 0,0) or an off-screen
+  // sprite whose top-left pixel sits at (originX, originY) on screen. Only
+  // primitives that sprites implement in RAM are used, so drawing a band never
+  // touches the bus while the previous band is still streaming out.
+  struct ChartCanvas
   {
-    if (!state.hasRunningAverage)
-      return;
+    TFT_eSPI &gfx;
+    int originX;
+    int originY;
+
+    void fillRect(int x, int y, int w, int h, uint16_t color)
+    {
+      gfx.fillRect(x - originX, y - originY, w, h, color);
+    }
 
-    int yAvg = priceToY(state.runningAverage, range, xAxisY, drawableH);
-    if (yAvg < kChartY)
-      yAvg = kChartY;
-    if (yAvg > xAxisY)
-      yAvg = xAxisY;
+    void hLine(int x, int y, int w, uint16_t color)
+    {
+      gfx.drawFastHLine(x - originX, y - originY, w, color);
+    }
 
-    for (int x = kChartX; x < (kChartX + kChartW); x += 6)
+    void vLine(int x, int y, int h, uint16_t color)
     {
-      tft.drawFastHLine(x, yAvg, 3, kAverageLineColor);
+      gfx.drawFastVLine(x - originX, y - originY, h, color);
     }
+  };
 
+  template <typename Profile>
+  void drawRunningAverage(ChartCanvas &canvas, const ChartModel &chart)
+  {
+    if (!chart.hasAverage)
+      return;
+
+    for (int x = Profile::kChartX; x < (Profile::kChartX + Profile::kChartW); x += 6)
+    {
+      canvas.hLine(x, chart.averageY, 3, kAverageLineColor);
+    }
   }
 
-  void drawCurrentArrow(int barX, int barW, int barY)
+  template <typename Profile>
+  void drawCurrentArrow(ChartCanvas &canvas, int barX, int barW, int barY)
   {
     const int centerX = barX + (barW / 2);
     int tipY = barY - 1;
-    if (tipY < (kChartY + 3))
-      tipY = kChartY + 3;
+    if (tipY < (Profile::kChartY + 3))
+      tipY = Profile::kChartY + 3;
 
-    int baseY = tipY - kCurrentArrowHeight;
-    if (baseY < (kChartY + 1))
+    int baseY = tipY - Profile::kCurrentArrowHeight;
+    if (baseY < (Profile::kChartY + 1))
     {
-      baseY = kChartY + 1;
-      tipY = baseY + kCurrentArrowHeight;
+      baseY = Profile::kChartY + 1;
+      tipY = baseY + Profile::kCurrentArrowHeight;
     }
 
-    tft.fillTriangle(
-        centerX - kCurrentArrowHalfWidth,
-        baseY,
-        centerX + kCurrentArrowHalfWidth,
-        baseY,
-        centerX,
-        tipY,
-        kCurrentArrowColor);
+    // Scanline fill: fillTriangle() opens a bus transaction even on sprites.
+    for (int y = baseY; y <= tipY; ++y)
+    {
+      const int half =
+          (Profile::kCurrentArrowHalfWidth * (tipY - y) + (Profile::kCurrentArrowHeight / 2)) / Profile::kCurrentArrowHeight;
+      canvas.hLine(centerX - half, y, (2 * half) + 1, kCurrentArrowColor);
+    }
   }
 
-  void drawCurrentMarker(const PriceState &state, const ChartRange &range, int xAxisY, int drawableH)
+  template <typename Profile>
+  void drawCurrentMarker(ChartCanvas &canvas, const ChartModel &chart, int currentIndex)
   {
-    if (state.currentIndex < 0 || state.currentIndex >= (int)state.count)
+    if (currentIndex < 0 || currentIndex >= chart.count || chart.pointColumn[currentIndex] < 0)
       return;
-    const int pointCount = (int)state.count;
-    const int i = state.currentIndex;
-    const int x0 = kChartX + (((int)i * kChartW) / pointCount);
-    const int x1 = kChartX + ((((int)i + 1) * kChartW) / pointCount);
-    const int w = max(1, x1 - x0);
-    const int y = priceToY(state.points[i].price, range, xAxisY, drawableH);
+    const int column = chart.pointColumn[currentIndex];
+    const int x0 = chart.columnX[column];
+    const int w = chart.columnW[column];
+    const int y = chart.columnTopY[column];
     // Thin pointer line from chart top down to bar top; arrow is drawn on top.
     const int centerX = x0 + (w / 2);
-    const int lineEnd = max(y - 1, kChartY);
-    tft.drawFastVLine(centerX, kChartY, lineEnd - kChartY + 1, kCurrentArrowColor);
-    drawCurrentArrow(x0, w, y);
+    const int lineEnd = max(y - 1, Profile::kChartY);
+    canvas.vLine(centerX, Profile::kChartY, lineEnd - Profile::kChartY + 1, kCurrentArrowColor);
+    drawCurrentArrow<Profile>(canvas, x0, w, y);
   }
 
-  void drawBars(const PriceState &state, const ChartRange &range, const LevelBand bands[5], int xAxisY, int drawableH)
+  template <typename Profile>
+  void drawBars(ChartCanvas &canvas, const ChartModel &chart)
   {
-    char lastDay[11] = {0};
-    bool hasLastDay = false;
-    const int pointCount = (int)state.count;
-    for (size_t i = 0; i < state.count; ++i)
+    using Layout = DisplayLayout<Profile>;
+    const int clipTop = canvas.originY;
+    const int clipBottom = canvas.originY + canvas.gfx.height();
+    for (int c = 0; c < chart.columnCount; ++c)
     {
-      const PricePoint &p = state.points[i];
-      const int x0 = kChartX + (((int)i * kChartW) / pointCount);
-      const int x1 = kChartX + ((((int)i + 1) * kChartW) / pointCount);
-      const int x = x0;
-      const int w = max(1, x1 - x0);
-      const int y = priceToY(p.price, range, xAxisY, drawableH);
-      const int h = xAxisY - y + 1;
-
-      if (h > 0)
-      {
-        tft.fillRect(x, y, w, h, barGradientColor(p, bands, range));
-      }
+      const int top = chart.columnTopY[c];
+      const int low = chart.columnLowY[c];
 
-      if (p.startsAt.length() < 10)
-        continue;
-      const char *startsAt = p.startsAt.c_str();
-      char dayKey[11];
-      memcpy(dayKey, startsAt, 10);
-      dayKey[10] = '\0';
-      if (hasLastDay && strncmp(dayKey, lastDay, 10) == 0)
+      // Columns that miss the current band entirely.
+      if (top > Layout::kChartAxisY || top >= clipBottom || Layout::kChartAxisY < clipTop)
         continue;
-
-      memcpy(lastDay, dayKey, sizeof(lastDay));
-      hasLastDay = true;
-
-      char dayText[6];
-      dayText[0] = startsAt[8];
-      dayText[1] = startsAt[9];
-      dayText[2] = '/';
-      dayText[3] = startsAt[5];
-      dayText[4] = startsAt[6];
-      dayText[5] = '\0';
-      tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
-      tft.setTextFont(kTopXAxisFontSize);
-      tft.setTextDatum(TC_DATUM);
-      tft.drawString(dayText, x, kDayLabelY);
-      tft.setTextDatum(TL_DATUM);
+      if (low > top)
+      {
+        canvas.fillRect(chart.columnX[c], top, chart.columnW[c], low - top, chart.columnTopColor[c]);
+      }
+      canvas.fillRect(chart.columnX[c], low, chart.columnW[c], Layout::kChartAxisY - low + 1, chart.columnLowColor[c]);
     }
   }
 
-  void drawXAxisTicks(const PriceState &state)
+  template <typename Profile>
+  void drawXAxisTicks(ChartCanvas &canvas, const ChartModel &chart)
   {
-    if (state.count == 0)
-      return;
-
-    const int pointCount = (int)state.count;
     // Ticks hang down from the top interior edge of the chart.
-    const int tickTopY = kChartY;
+    for (int i = chart.first; i < chart.last; ++i)
+    {
+      if (chart.tickLen[i] != 0)
+      {
+        canvas.vLine(chart.columnX[chart.pointColumn[i]], Profile::kChartY, chart.tickLen[i], TFT_LIGHTGREY);
+      }
+    }
+  }
+
+  // Day and hour labels sit above the chart border, outside any chart sprite.
+  template <typename Profile>
+  void drawXAxisLabels(const PriceState &state, const ChartModel &chart)
+  {
+    using Layout = DisplayLayout<Profile>;
+    StageScope stage(kStageAxes);
     // Labels sit just above the chart top border (2 px gap before border at kChartY-1).
-    const int labelY = tickTopY - 10;
+    const int labelY = Profile::kChartY - 10;
+    char lastDay[11] = {0};
+    bool hasLastDay = false;
 
-    tft.setTextFont(1);
     tft.setTextColor(TFT_LIGHTGREY, TFT_BLACK);
     tft.setTextDatum(TC_DATUM);
 
-    for (size_t i = 0; i < state.count; ++i)
+    for (int i = chart.first; i < chart.last; ++i)
     {
       const PricePoint &p = state.points[i];
-      if (p.startsAt.length() < 16)
+      if (p.startsAt.length() < 10)
         continue;
       const char *s = p.startsAt.c_str();
-      if (s[10] != 'T')
-        continue;
+      const int x = chart.columnX[chart.pointColumn[i]];
 
+      if (!hasLastDay || strncmp(s, lastDay, 10) != 0)
+      {
+        memcpy(lastDay, s, 10);
+        lastDay[10] = '\0';
+        hasLastDay = true;
+
+        char dayText[6];
+        dayText[0] = s[8];
+        dayText[1] = s[9];
+        dayText[2] = '/';
+        dayText[3] = s[5];
+        dayText[4] = s[6];
+        dayText[5] = '\0';
+        tft.setTextFont(kTopXAxisFontSize);
+        tft.drawString(dayText, x, Layout::kDayLabelY);
+      }
+
+      if (p.startsAt.length() < 16 || s[10] != 'T')
+        continue;
       const int hour   = (s[11] - '0') * 10 + (s[12] - '0');
       const int minute = (s[14] - '0') * 10 + (s[15] - '0');
-      if (minute != 0)
+      // Skip "00" — date label is shown at that position
+      if (minute != 0 || hour % 6 != 0 || hour == 0)
         continue;
 
-      const int x = kChartX + (((int)i * kChartW) / pointCount);
-      const bool isMajor = (hour % 6 == 0);
+      char label[3];
+      snprintf(label, sizeof(label), "%02d", hour);
+      tft.setTextFont(1);
+      tft.drawString(label, x, labelY);
+    }
+
+    tft.setTextDatum(TL_DATUM);
+  }
+
+  template <typename Profile>
+  void drawChartInterior(ChartCanvas &canvas, const ChartModel &chart, int currentIndex)
+  {
+    using Layout = DisplayLayout<Profile>;
+    {
+      StageScope stage(kStageBars);
+      canvas.hLine(Profile::kChartX, Layout::kChartAxisY, Profile::kChartW, TFT_DARKGREY);
+      drawBars<Profile>(canvas, chart);
+    }
+    {
+      StageScope stage(kStageTicks);
+      drawXAxisTicks<Profile>(canvas, chart);
+    }
+    {
+      StageScope stage(kStageAverage);
+      drawRunningAverage<Profile>(canvas, chart);
+    }
+    StageScope stage(kStageMarker);
+    drawCurrentMarker<Profile>(canvas, chart, currentIndex);
+  }
+
+  // Assumes the chart area is already black.
+  template <typename Profile>
+  void renderChartDirect(const ChartModel &chart, int currentIndex)
+  {
+    ChartCanvas canvas{tft, 0, 0};
+    drawChartInterior<Profile>(canvas, chart, currentIndex);
+  }
+
+  // Whole chart in one sprite. Only fits in heap on the smaller panel or with PSRAM.
+  template <typename Profile>
+  bool renderChartSprite(const ChartModel &chart, int currentIndex)
+  {
+    TFT_eSprite sprite(&tft);
+    sprite.setColorDepth(16);
+    if (sprite.createSprite(Profile::kChartW, Profile::kChartH) == nullptr)
+      return false;
+
+    sprite.fillSprite(TFT_BLACK);
+    ChartCanvas canvas{sprite, Profile::kChartX, Profile::kChartY};
+    drawChartInterior<Profile>(canvas, chart, currentIndex);
+    {
+      StageScope stage(kStagePush);
+      sprite.pushSprite(Profile::kChartX, Profile::kChartY);
+      noteBlockPush(Profile::kChartX, Profile::kChartY, Profile::kChartW, Profile::kChartH);
+    }
+    sprite.deleteSprite();
+    return true;
+  }
+
+  template <typename Profile>
+  bool ensureBandSprites()
+  {
+    if (gBandSpritesAttempted)
+      return gBandSpritesReady;
 
-      if (isMajor)
+    gBandSpritesAttempted = true;
+    for (TFT_eSprite *sprite : gBandSprites)
+    {
+      sprite->setColorDepth(16);
+#if DISPLAY_CHART_DMA
+      // DMA cannot read from PSRAM.
+      sprite->setAttribute(PSRAM_ENABLE, false);
+#endif
+      if (sprite->createSprite(Profile::kChartW, kChartBandRows) == nullptr)
       {
-        // Tall tick hanging down from top of chart.
-        tft.drawFastVLine(x, tickTopY, 8, TFT_LIGHTGREY);
-        if (hour != 0)  // Skip "00" — date label is shown at that position
+        for (TFT_eSprite *created : gBandSprites)
         {
-          char label[3];
-          snprintf(label, sizeof(label), "%02d", hour);
-          tft.drawString(label, x, labelY);
+          created->deleteSprite();
         }
-      }
-      else
-      {
-        // Short tick hanging down from top of chart.
-        tft.drawFastVLine(x, tickTopY, 4, TFT_LIGHTGREY);
+        logf("Display chart bands: no heap for %ux%u", (unsigned)Profile::kChartW, (unsigned)kChartBandRows);
+        return false;
       }
     }
+    gBandSpritesReady = true;
+    return true;
+  }
 
-    tft.setTextDatum(TL_DATUM);
+  // Composes the chart in kChartBandRows-high strips, alternating between two
+  // sprites so the next strip is drawn while the previous one is pushed.
+  template <typename Profile>
+  bool renderChartBanded(const ChartModel &chart, int currentIndex)
+  {
+    if (!ensureBandSprites<Profile>())
+      return false;
+
+    // Sprite buffers already hold panel byte order.
+    const bool swapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(false);
+#if DISPLAY_CHART_DMA
+    tft.startWrite();
+#endif
+    int band = 0;
+    for (int bandY = Profile::kChartY; bandY < (Profile::kChartY + Profile::kChartH); bandY += kChartBandRows)
+    {
+      TFT_eSprite &sprite = *gBandSprites[band & 1];
+      const int rows = min(kChartBandRows, Profile::kChartY + Profile::kChartH - bandY);
+      sprite.fillSprite(TFT_BLACK);
+      ChartCanvas canvas{sprite, Profile::kChartX, bandY};
+      drawChartInterior<Profile>(canvas, chart, currentIndex);
+      StageScope stage(kStagePush);
+#if DISPLAY_CHART_DMA
+      // Waits for the previous band before starting, so the sprite drawn next
+      // is never the one still being read by DMA.
+      tft.pushImageDMA(Profile::kChartX, bandY, Profile::kChartW, rows, (uint16_t *)sprite.getPointer());
+#else
+      tft.pushImage(Profile::kChartX, bandY, Profile::kChartW, rows, (uint16_t *)sprite.getPointer());
+#endif
+      noteBlockPush(Profile::kChartX, bandY, Profile::kChartW, rows);
+      ++band;
+    }
+#if DISPLAY_CHART_DMA
+    {
+      StageScope stage(kStagePush);
+      tft.dmaWait();
+      tft.endWrite();
+    }
+#endif
+    tft.setSwapBytes(swapBytes);
+    return true;
+  }
+
+#if CONFIG_DISPLAY_FRAME_TIMING
+  void formatFrameTime(bool ok, uint32_t us, char *out, size_t outSize)
+  {
+    if (ok)
+    {
+      snprintf(out, outSize, "%luus", (unsigned long)us);
+    }
+    else
+    {
+      snprintf(out, outSize, "no-heap");
+    }
+  }
+
+  // Draws the same chart with every method back to back; all leave identical pixels.
+  template <typename Profile>
+  void renderChartTimed(const ChartModel &chart, int currentIndex)
+  {
+    uint32_t start = micros();
+    tft.fillRect(Profile::kChartX, Profile::kChartY, Profile::kChartW, Profile::kChartH, TFT_BLACK);
+    renderChartDirect<Profile>(chart, currentIndex);
+    const uint32_t directUs = micros() - start;
+
+    start = micros();
+    const bool spriteOk = renderChartSprite<Profile>(chart, currentIndex);
+    const uint32_t spriteUs = micros() - start;
+
+    start = micros();
+    const bool bandedOk = renderChartBanded<Profile>(chart, currentIndex);
+    const uint32_t bandedUs = micros() - start;
+
+    char spriteText[16];
+    char bandedText[16];
+    formatFrameTime(spriteOk, spriteUs, spriteText, sizeof(spriteText));
+    formatFrameTime(bandedOk, bandedUs, bandedText, sizeof(bandedText));
+    logf(
+        "Display chart frame: points=%u columns=%u direct=%luus sprite=%s banded=%s dma=%s",
+        (unsigned)chart.count,
+        (unsigned)chart.columnCount,
+        (unsigned long)directUs,
+        spriteText,
+        bandedText,
+        DISPLAY_CHART_DMA ? "on" : "off");
+  }
+#endif
+
+  template <typename Profile>
+  void renderChart(const ChartModel &chart, int currentIndex, bool chartCleared)
+  {
+#if CONFIG_DISPLAY_FRAME_TIMING
+    (void)chartCleared;
+    renderChartTimed<Profile>(chart, currentIndex);
+#else
+    if (kChartRenderMode == ChartRenderMode::Sprite && renderChartSprite<Profile>(chart, currentIndex))
+      return;
+    if (kChartRenderMode != ChartRenderMode::Direct && renderChartBanded<Profile>(chart, currentIndex))
+      return;
+    if (!chartCleared)
+    {
+      StageScope stage(kStageClear);
+      tft.fillRect(Profile::kChartX, Profile::kChartY, Profile::kChartW, Profile::kChartH, TFT_BLACK);
+    }
+    renderChartDirect<Profile>(chart, currentIndex);
+#endif
   }
 
+  template <typename Profile>
   void drawCenteredLine(const char *text, int y, int font, uint16_t color)
   {
     tft.setTextDatum(MC_DATUM);
     tft.setTextFont(font);
     tft.setTextColor(color, TFT_BLACK);
-    tft.drawString((text != nullptr) ? text : "", kScreenCenterX, y);
+    tft.drawString((text != nullptr) ? text : "", Profile::kScreenCenterX, y);
   }
 
+  template <typename Profile>
   void drawCenteredLine(const String &text, int y, int font, uint16_t color)
   {
-    drawCenteredLine(text.c_str(), y, font, color);
+    drawCenteredLine<Profile>(text.c_str(), y, font, color);
   }
 
   void drawFetchErrorBanner()
   {
+    StageScope stage(kStageText);
     tft.setTextFont(2);
     tft.setTextColor(TFT_RED, TFT_BLACK);
     tft.setTextDatum(TL_DATUM);
     tft.drawString("Failed to contact Nordpool!", 4, kSourceLabelY + 5);
   }
+  uint32_t computeChartSignature(const PriceState &state)
+  {
+    uint32_t crc = kCrc32Init;
+    crc = crc32Update(crc, (const uint8_t *)&state.count, sizeof(state.count));
+    for (size_t i = 0; i < state.count; ++i)
+    {
+      const PricePoint &p = state.points[i];
+      crc = crc32Update(crc, (const uint8_t *)&p.price, sizeof(p.price));
+      crc = crc32Update(crc, (const uint8_t *)p.level.c_str(), p.level.length());
+      crc = crc32Update(crc, (const uint8_t *)p.startsAt.c_str(), p.startsAt.length());
+    }
+    const uint8_t flags = (state.hasRunningAverage ? 1 : 0) | (state.error.isEmpty() ? 0 : 2);
+    crc = crc32Update(crc, &flags, sizeof(flags));
+    crc = crc32Update(crc, (const uint8_t *)&state.runningAverage, sizeof(state.runningAverage));
+    return crc32Finish(crc);
+  }
+
+  // Columns touched by the current-slot bar, pointer line and arrow.
+  template <typename Profile>
+  void markerSpan(const ChartModel &chart, int index, int &xa, int &xb)
+  {
+    const int column = chart.pointColumn[index];
+    const int x0 = chart.columnX[column];
+    const int w = chart.columnW[column];
+    const int centerX = x0 + (w / 2);
+    xa = min(x0, centerX - Profile::kCurrentArrowHalfWidth);
+    xb = max(x0 + w - 1, centerX + Profile::kCurrentArrowHalfWidth);
+  }
+
+  // Repaints the chart interior between columns xa..xb, clipped to that strip.
+  template <typename Profile>
+  uint32_t repaintChartColumns(
+      const ChartModel &chart,
+      int currentIndex,
+      int xa,
+      int xb)
+  {
+    xa = max(xa, Profile::kChartX);
+    xb = min(xb, Profile::kChartX + Profile::kChartW - 1);
+    if (xb < xa)
+      return 0;
+
+    const int w = xb - xa + 1;
+    tft.setViewport(xa, Profile::kChartY, w, Profile::kChartH, false);
+    {
+      StageScope stage(kStageClear);
+      tft.fillRect(xa, Profile::kChartY, w, Profile::kChartH, TFT_BLACK);
+    }
+    renderChartDirect<Profile>(chart, currentIndex);
+    tft.resetViewport();
+    return (uint32_t)w * (uint32_t)Profile::kChartH;
+  }
+
+  template <typename Profile>
+  uint32_t clearPriceBox(const ScreenRect &box)
+  {
+    using Layout = DisplayLayout<Profile>;
+    const int x0 = max(box.x, 0);
+    const int y0 = max(box.y, 0);
+    const int x1 = min(box.x + box.w, (int)tft.width());
+    const int y1 = min(box.y + box.h, Layout::kDayLabelY);
+    if (x1 <= x0 || y1 <= y0)
+      return 0;
+    StageScope stage(kStageClear);
+    tft.fillRect(x0, y0, x1 - x0, y1 - y0, TFT_BLACK);
+    return (uint32_t)(x1 - x0) * (uint32_t)(y1 - y0);
+  }
+
+  template <typename Profile>
+  void drawChangedRegions(
+      const PriceState &state,
+      const ChartModel &chart,
+      const char *priceText,
+      const char *currencyText,
+      uint16_t priceColor)
+  {
+    uint32_t pixels = 0;
+    if (strcmp(priceText, gFrame.priceText) != 0 || strcmp(currencyText, gFrame.currencyText) != 0 ||
+        priceColor != gFrame.priceColor)
+    {
+      pixels += clearPriceBox<Profile>(gFrame.priceBox);
+      // The cleared box can clip the clock and banner on narrow panels.
+      drawClockLabel<Profile>();
+      if (!state.error.isEmpty())
+      {
+        drawFetchErrorBanner();
+      }
+      gFrame.priceBox = drawPriceText<Profile>(priceText, currencyText, priceColor);
+      tft.setTextDatum(TL_DATUM);
+      pixels += (uint32_t)gFrame.priceBox.w * (uint32_t)gFrame.priceBox.h;
+      gFrame.priceColor = priceColor;
+      strncpy(gFrame.priceText, priceText, sizeof(gFrame.priceText));
+      strncpy(gFrame.currencyText, currencyText, sizeof(gFrame.currencyText));
+    }
+
+    if (state.currentIndex != gFrame.currentIndex)
+    {
+      const int current = state.currentIndex;
+      int newA = 0;
+      int newB = -1;
+      if (current >= 0 && current < chart.count && chart.pointColumn[current] >= 0)
+      {
+        markerSpan<Profile>(chart, current, newA, newB);
+      }
+      int oldA = 0;
+      int oldB = -1;
+      if (gFrame.currentIndex >= 0 && gFrame.currentIndex < chart.count && chart.pointColumn[gFrame.currentIndex] >= 0)
+      {
+        markerSpan<Profile>(chart, gFrame.currentIndex, oldA, oldB);
+      }
+
+      if (oldB >= oldA && newB >= newA && oldA <= newB + 1 && newA <= oldB + 1)
+      {
+        pixels += repaintChartColumns<Profile>(chart, current, min(oldA, newA), max(oldB, newB));
+      }
+      else
+      {
+        pixels += repaintChartColumns<Profile>(chart, current, oldA, oldB);
+        pixels += repaintChartColumns<Profile>(chart, current, newA, newB);
+      }
+      gFrame.currentIndex = current;
+    }
+
+    logf(
+        "Display partial update: pixels=%u full=%u",
+        (unsigned)pixels,
+        (unsigned)((uint32_t)tft.width() * (uint32_t)tft.height()));
+  }
+
+  // The rolling window moved with unchanged data: redraw the chart, its
+  // labels and the y axis in place, keep the rest of the screen.
+  template <typename Profile>
+  void drawShiftedWindow(
+      const PriceState &state,
+      const ChartModel &chart,
+      const char *priceText,
+      const char *currencyText,
+      uint16_t priceColor)
+  {
+    using Layout = DisplayLayout<Profile>;
+    {
+      // Label strip above the chart border, then the y-axis column left of it.
+      StageScope stage(kStageClear);
+      tft.fillRect(0, Layout::kDayLabelY, tft.width(), (Profile::kChartY - 1) - Layout::kDayLabelY, TFT_BLACK);
+      tft.fillRect(0, Profile::kChartY - 1, Profile::kChartX - 1, tft.height() - (Profile::kChartY - 1), TFT_BLACK);
+    }
+    drawYAxis<Profile>(chart.range, Layout::kChartAxisY, Layout::kChartDrawableH);
+    drawXAxisLabels<Profile>(state, chart);
+    renderChart<Profile>(chart, state.currentIndex, false);
+
+    gFrame.windowStart = chart.windowStart;
+    gFrame.currentIndex = state.currentIndex;
+    // Only the price text can still differ.
+    drawChangedRegions<Profile>(state, chart, priceText, currencyText, priceColor);
+  }
+
+  template <typename Profile>
+  void drawPricesScreen(const PriceState &state)
+  {
+    using Layout = DisplayLayout<Profile>;
+    StageFrame stageFrame;
+    tft.setTextWrap(false);
+    tft.setTextSize(1);
+
+    char priceText[16];
+    char currencyText[8];
+    formatPriceValue(state.currentPrice, priceText, sizeof(priceText));
+    formatCurrencyLabel(state.currency, currencyText, sizeof(currencyText));
+
+    if (!state.ok || state.count == 0)
+    {
+      gFrame.valid = false;
+      {
+        StageScope stage(kStageClear);
+        tft.fillScreen(TFT_BLACK);
+      }
+      drawClockLabel<Profile>();
+      if (!state.ok)
+      {
+        drawErrorScreen<Profile>(state.error);
+        return;
+      }
+      if (!state.error.isEmpty())
+      {
+        drawFetchErrorBanner();
+      }
+      drawPriceText<Profile>(priceText, currencyText, levelColor(state.currentLevel));
+      tft.setTextDatum(TL_DATUM);
+      return;
+    }
+
+    const uint32_t signature = computeChartSignature(state);
+    const ChartWindow window = computeChartWindow(state);
+    if (!gChart.valid || gChart.signature != signature || gChart.windowStart != window.start)
+    {
+      buildChartModel<Profile>(state, signature, window);
+    }
+
+    uint16_t currentPriceColor = levelColor(state.currentLevel);
+    if (state.currentIndex >= 0 && state.currentIndex < gChart.count && gChart.pointColumn[state.currentIndex] >= 0)
+    {
+      currentPriceColor = gChart.pointColor[state.currentIndex];
+    }
+
+    if (gFrame.valid && gFrame.chartSignature == signature && gFrame.windowStart == gChart.windowStart)
+    {
+      drawChangedRegions<Profile>(state, gChart, priceText, currencyText, currentPriceColor);
+      logBusStats("partial");
+      return;
+    }
+    if (gFrame.valid && gFrame.chartSignature == signature)
+    {
+      drawShiftedWindow<Profile>(state, gChart, priceText, currencyText, currentPriceColor);
+      logBusStats("shift");
+      return;
+    }
+
+    {
+      StageScope stage(kStageClear);
+      tft.fillScreen(TFT_BLACK);
+    }
+    drawClockLabel<Profile>();
+    if (!state.error.isEmpty())
+    {
+      drawFetchErrorBanner();
+    }
+
+    gFrame.priceBox = drawPriceText<Profile>(priceText, currencyText, currentPriceColor);
+    tft.setTextDatum(TL_DATUM);
+
+    {
+      StageScope stage(kStageAxes);
+      tft.drawRect(Profile::kChartX - 1, Profile::kChartY - 1, Profile::kChartW + 2, Profile::kChartH + 2, TFT_DARKGREY);
+    }
+    drawYAxis<Profile>(gChart.range, Layout::kChartAxisY, Layout::kChartDrawableH);
+    drawXAxisLabels<Profile>(state, gChart);
+    renderChart<Profile>(gChart, state.currentIndex, true);
+
+    gFrame.valid = true;
+    gFrame.chartSignature = signature;
+    gFrame.windowStart = gChart.windowStart;
+    gFrame.currentIndex = state.currentIndex;
+    gFrame.priceColor = currentPriceColor;
+    strncpy(gFrame.priceText, priceText, sizeof(gFrame.priceText));
+    strncpy(gFrame.currencyText, currencyText, sizeof(gFrame.currencyText));
+    logBusStats("full");
+  }
+
+  template <typename Profile>
+  void drawPortalScreen(const char *apName, uint16_t timeoutSeconds)
+  {
+    gFrame.valid = false;
+    const char *ap = (apName != nullptr && apName[0] != '\0') ? apName : "ElMeter";
+    char timeoutBuf[24];
+    snprintf(timeoutBuf, sizeof(timeoutBuf), "Portal timeout: %us", (unsigned)timeoutSeconds);
+
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextWrap(false);
+    drawCenteredLine<Profile>("Wi-Fi Setup Mode", Profile::kWifiTitleY, 4, TFT_CYAN);
+    drawCenteredLine<Profile>("1) Connect phone/computer to:", Profile::kWifiStep1Y, 2, TFT_LIGHTGREY);
+    drawCenteredLine<Profile>(ap, Profile::kWifiApNameY, 2, TFT_WHITE);
+    drawCenteredLine<Profile>("2) Open: 192.168.4.1", Profile::kWifiStep2Y, 2, TFT_LIGHTGREY);
+    drawCenteredLine<Profile>("3) Select Wi-Fi and Save", Profile::kWifiStep3Y, 2, TFT_LIGHTGREY);
+    drawCenteredLine<Profile>("4) Select Nord Pool area,", Profile::kWifiStep4aY, 2, TFT_LIGHTGREY);
+    drawCenteredLine<Profile>("   currency, and resolution", Profile::kWifiStep4bY, 2, TFT_LIGHTGREY);
+    drawCenteredLine<Profile>(timeoutBuf, Profile::kWifiTimeoutY, 2, TFT_YELLOW);
+  }
+
+  // Public entry points bound to one profile; displayInitFor() picks the set.
+  struct ProfileScreens
+  {
+    void (*drawPrices)(const PriceState &state);
+    void (*refreshClock)();
+    void (*drawPortal)(const char *apName, uint16_t timeoutSeconds);
+  };
+
+  template <typename Profile>
+  const ProfileScreens *profileScreens()
+  {
+    static const ProfileScreens screens = {drawPricesScreen<Profile>, drawClockLabel<Profile>, drawPortalScreen<Profile>};
+    return &screens;
+  }
+
+  const ProfileScreens *gScreens = profileScreens<ActiveProfile>();
 } // namespace
 
-void displayInit()
+template <typename Profile>
+void displayInitFor()
 {
   hardResetController();
+  bootMark(BootPhase::PanelReset);
   tft.init();
+  bootMark(BootPhase::PanelInit);
   tft.writecommand(0x11); // SLPOUT
   delay(120);
   tft.writecommand(0x29); // DISPON
   delay(20);
+  bootMark(BootPhase::PanelWake);
   tft.setRotation(1);
   ofr.setDrawer(tft);
   ofr.setBackgroundFillMethod(BgFillMethod::Block);
+#if DISPLAY_CHART_DMA
+  tft.initDMA();
+#endif
   gOpenFontReady = (ofr.loadFont(NotoSans_Bold, sizeof(NotoSans_Bold)) == 0);
+  bootMark(BootPhase::FontLoad);
   logf("Display OpenFontRender: %s", gOpenFontReady ? "ready" : "fallback");
-}
-
-void displayDrawPrices(const PriceState &state)
-{
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextWrap(false);
-  tft.setTextSize(1);
-  drawClockLabel();
-
-  if (!state.ok)
+  // Chart bands and cached geometry of a previously used profile do not fit this one.
+  for (TFT_eSprite *sprite : gBandSprites)
   {
-    drawErrorScreen(state.error);
-    return;
+    sprite->deleteSprite();
   }
-
-  if (!state.error.isEmpty())
+  gBandSpritesAttempted = false;
+  gBandSpritesReady = false;
+  gChart.valid = false;
+  gFrame.valid = false;
+#if CONFIG_DISPLAY_STAGE_TIMING
+  // Timings of another layout would blur this one's percentiles.
+  for (StageStats &stats : gStages)
   {
-    drawFetchErrorBanner();
+    stats = StageStats();
   }
+  gStageFrames = 0;
+#endif
+  gScreens = profileScreens<Profile>();
+  buildPriceAtlases<Profile>();
+  bootMark(BootPhase::DisplayReady);
+}
 
-  if (state.count == 0)
-  {
-    drawPriceText(state.currentPrice, state.currency, levelColor(state.currentLevel));
-    tft.setTextDatum(TL_DATUM);
-    return;
-  }
+template void displayInitFor<Ili9488LandscapeProfile>();
+template void displayInitFor<Ili9341LandscapeProfile>();
 
-  const int xAxisY = kChartY + kChartH - 1;
-  const int drawableH = kChartH - 4;
-  const ChartRange range = computeChartRange(state);
-  LevelBand bands[5];
-  computeLevelBands(state, bands);
+void displayInit()
+{
+  displayInitFor<ActiveProfile>();
+}
 
-  uint16_t currentPriceColor = levelColor(state.currentLevel);
-  if (state.currentIndex >= 0 && state.currentIndex < (int)state.count)
-  {
-    currentPriceColor = barGradientColor(state.points[state.currentIndex], bands, range);
-  }
-  drawPriceText(state.currentPrice, state.currency, currentPriceColor);
-  tft.setTextDatum(TL_DATUM);
+void displayDrawPrices(const PriceState &state)
+{
+  gScreens->drawPrices(state);
+}
 
-  tft.drawRect(kChartX - 1, kChartY - 1, kChartW + 2, kChartH + 2, TFT_DARKGREY);
-  tft.drawFastHLine(kChartX, xAxisY, kChartW, TFT_DARKGREY);
-  drawYAxis(range, xAxisY, drawableH);
-  drawBars(state, range, bands, xAxisY, drawableH);
-  drawXAxisTicks(state);
-  drawRunningAverage(state, range, xAxisY, drawableH);
-  drawCurrentMarker(state, range, xAxisY, drawableH);
+void displayInvalidate()
+{
+  gFrame.valid = false;
 }
 
 void displayRefreshClock()
 {
-  drawClockLabel();
+  gScreens->refreshClock();
 }
 
 void displayDrawWifiConfigPortal(const char *apName, uint16_t timeoutSeconds)
 {
-  const char *ap = (apName != nullptr && apName[0] != '\0') ? apName : "ElMeter";
-  char timeoutBuf[24];
-  snprintf(timeoutBuf, sizeof(timeoutBuf), "Portal timeout: %us", (unsigned)timeoutSeconds);
-
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextWrap(false);
-  drawCenteredLine("Wi-Fi Setup Mode", kWifiTitleY, 4, TFT_CYAN);
-  drawCenteredLine("1) Connect phone/computer to:", kWifiStep1Y, 2, TFT_LIGHTGREY);
-  drawCenteredLine(ap, kWifiApNameY, 2, TFT_WHITE);
-  drawCenteredLine("2) Open: 192.168.4.1", kWifiStep2Y, 2, TFT_LIGHTGREY);
-  drawCenteredLine("3) Select Wi-Fi and Save", kWifiStep3Y, 2, TFT_LIGHTGREY);
-  drawCenteredLine("4) Select Nord Pool area,", kWifiStep4aY, 2, TFT_LIGHTGREY);
-  drawCenteredLine("   currency, and resolution", kWifiStep4bY, 2, TFT_LIGHTGREY);
-  drawCenteredLine(timeoutBuf, kWifiTimeoutY, 2, TFT_YELLOW);
+  gScreens->drawPortal(apName, timeoutSeconds);
 }
 
-void displayDrawWifiConfigTimeout(uint16_t timeoutSeconds)
+size_t displayStageTimings(DisplayStageTiming *out, size_t maxStages)
 {
-  char timeoutBuf[40];
-  snprintf(timeoutBuf, sizeof(timeoutBuf), "Timed out after %us", (unsigned)timeoutSeconds);
-
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextWrap(false);
-  drawCenteredLine("Wi-Fi Setup Timed Out", kWifiToutTitleY, 4, TFT_RED);
-  drawCenteredLine(timeoutBuf, kWifiToutMsgY, 2, TFT_LIGHTGREY);
-  drawCenteredLine("Press reset or reboot to retry", kWifiToutRetryY, 2, TFT_LIGHTGREY);
+#if CONFIG_DISPLAY_STAGE_TIMING
+  size_t filled = 0;
+  for (uint8_t i = 0; i < kStageCount && filled < maxStages; ++i)
+  {
+    const StageStats &stats = gStages[i];
+    if (stats.count == 0)
+      continue;
+    DisplayStageTiming &timing = out[filled++];
+    timing.name = kStageNames[i];
+    timing.samples = (uint16_t)stats.count;
+    timing.p50Us = cyclesToUs(percentile(stats.cycles, stats.count, 50));
+    timing.p99Us = cyclesToUs(percentile(stats.cycles, stats.count, 99));
+    timing.p50Bytes = percentile(stats.bytes, stats.count, 50);
+    timing.p99Bytes = percentile(stats.bytes, stats.count, 99);
+  }
+  return filled;
+#else
+  (void)out;
+  (void)maxStages;
+  return 0;
+#endif
 }
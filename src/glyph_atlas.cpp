@@ -0,0 +1,274 @@
+#include "glyph_atlas.h"
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging_utils.h"
+
+namespace {
+constexpr int kScratchMarginPx = 4;
+constexpr int kMaxLineWidth = 480;
+constexpr size_t kMaxTextGlyphs = 16;
+
+// Row scratch for the blitter; display drawing is single threaded.
+uint8_t gCoverageRow[kMaxLineWidth];
+uint16_t gColorRow[kMaxLineWidth];
+
+int inkWidth(OpenFontRender &ofr, const char *text) {
+  return (int)ofr.getTextWidth("%s", text);
+}
+
+// Horizontal gap between the ink of `a` and `b` when drawn as "ab".
+int pairGap(OpenFontRender &ofr, char a, char b) {
+  const char pair[3] = {a, b, '\0'};
+  const char first[2] = {a, '\0'};
+  const char second[2] = {b, '\0'};
+  return inkWidth(ofr, pair) - inkWidth(ofr, first) - inkWidth(ofr, second);
+}
+
+const AtlasGlyph *findGlyph(const GlyphAtlas &atlas, char code) {
+  for (size_t i = 0; i < atlas.glyphCount; ++i) {
+    if (atlas.glyphs[i].code == code) return &atlas.glyphs[i];
+  }
+  return nullptr;
+}
+
+// Extra gap between two glyphs from the font's kerning table, if the atlas has one.
+int kerningBetween(const GlyphAtlas &atlas, const AtlasGlyph *left, const AtlasGlyph *right) {
+  if (atlas.kerning == nullptr) return 0;
+  return atlas.kerning[(size_t)(left - atlas.glyphs) * atlas.glyphCount + (size_t)(right - atlas.glyphs)];
+}
+
+// Rendered white on black, so the green channel is the coverage.
+uint8_t coverageAt(TFT_eSprite &scratch, int x, int y) {
+  const uint16_t green = (scratch.readPixel(x, y) >> 5) & 0x3F;
+  return (uint8_t)((green * 15 + 31) / 63);
+}
+
+int firstInkColumn(TFT_eSprite &scratch, int width, int height) {
+  for (int x = 0; x < width; ++x) {
+    for (int y = 0; y < height; ++y) {
+      if (coverageAt(scratch, x, y) != 0) return x;
+    }
+  }
+  return -1;
+}
+
+void renderPair(OpenFontRender &ofr, TFT_eSprite &scratch, char reference, char code) {
+  const char pair[3] = {reference, code, '\0'};
+  scratch.fillSprite(TFT_BLACK);
+  ofr.setCursor(kScratchMarginPx, scratch.height() / 2);
+  ofr.printf("%s", pair);
+}
+
+uint16_t blend565(uint16_t from, uint16_t to, uint8_t coverage) {
+  const int r0 = (from >> 11) & 0x1F;
+  const int g0 = (from >> 5) & 0x3F;
+  const int b0 = from & 0x1F;
+  const int r = r0 + ((((to >> 11) & 0x1F) - r0) * coverage + 7) / 15;
+  const int g = g0 + ((((to >> 5) & 0x3F) - g0) * coverage + 7) / 15;
+  const int b = b0 + (((to & 0x1F) - b0) * coverage + 7) / 15;
+  return (uint16_t)((r << 11) | (g << 5) | b);
+}
+}  // namespace
+
+bool glyphAtlasBuild(GlyphAtlas &atlas, OpenFontRender &ofr, TFT_eSPI &tft, const char *charset, char reference,
+                     unsigned fontSize) {
+  glyphAtlasFree(atlas);
+  const size_t count = strlen(charset);
+  if (count == 0 || count > GlyphAtlas::kMaxGlyphs) return false;
+
+  ofr.setFontSize(fontSize);
+  const int referenceGap = pairGap(ofr, reference, reference);
+  // Only pair sums matter, so the reference's own gap is split evenly.
+  const int referenceLeft = referenceGap / 2;
+  const int referenceRight = referenceGap - referenceLeft;
+
+  int scratchWidth = 0;
+  int scratchHeight = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const char pair[3] = {reference, charset[i], '\0'};
+    scratchWidth = max(scratchWidth, inkWidth(ofr, pair));
+    scratchHeight = max(scratchHeight, (int)ofr.getTextHeight("%s", pair));
+  }
+  scratchWidth += 2 * kScratchMarginPx;
+  scratchHeight += 2 * kScratchMarginPx;
+
+  TFT_eSprite scratch(&tft);
+  scratch.setColorDepth(16);
+  if (scratch.createSprite(scratchWidth, scratchHeight) == nullptr) {
+    logf("Glyph atlas: no heap for %dx%d scratch", scratchWidth, scratchHeight);
+    return false;
+  }
+
+  // Drawing each glyph after the reference keeps OFR's middle alignment on
+  // the reference's box, so every glyph lands on the same baseline.
+  ofr.setDrawer(scratch);
+  ofr.setFontColor(TFT_WHITE, TFT_BLACK);
+  ofr.setAlignment(Align::MiddleLeft);
+
+  renderPair(ofr, scratch, reference, reference);
+  int top = scratchHeight;
+  int bottom = -1;
+  for (int y = 0; y < scratchHeight; ++y) {
+    for (int x = 0; x < scratchWidth; ++x) {
+      if (coverageAt(scratch, x, y) == 0) continue;
+      top = min(top, y);
+      bottom = max(bottom, y);
+      break;
+    }
+  }
+
+  size_t bytes = 0;
+  for (size_t i = 0; i < count && bottom >= top; ++i) {
+    const char glyphText[2] = {charset[i], '\0'};
+    AtlasGlyph &glyph = atlas.glyphs[i];
+    glyph.code = charset[i];
+    glyph.width = (uint16_t)inkWidth(ofr, glyphText);
+    glyph.leftPad = (int8_t)(pairGap(ofr, reference, charset[i]) - referenceRight);
+    glyph.rightPad = (int8_t)(pairGap(ofr, charset[i], reference) - referenceLeft);
+    glyph.offset = bytes;
+    bytes += (size_t)((glyph.width + 1) / 2) * (size_t)(bottom - top + 1);
+  }
+
+  uint8_t *pixels = bytes > 0 ? (uint8_t *)calloc(bytes, 1) : nullptr;
+  if (pixels == nullptr) {
+    ofr.setDrawer(tft);
+    scratch.deleteSprite();
+    logf("Glyph atlas: no heap for %u bytes", (unsigned)bytes);
+    return false;
+  }
+
+  atlas.pixels = pixels;
+  atlas.ownsPixels = true;
+  atlas.glyphCount = count;
+  atlas.height = (uint16_t)(bottom - top + 1);
+  atlas.bytes = bytes;
+  for (size_t i = 0; i < count; ++i) {
+    const AtlasGlyph &glyph = atlas.glyphs[i];
+    const char pair[3] = {reference, glyph.code, '\0'};
+    renderPair(ofr, scratch, reference, glyph.code);
+    const int inkStart = firstInkColumn(scratch, scratchWidth, scratchHeight);
+    if (inkStart < 0) continue;
+
+    const int glyphX = inkStart + inkWidth(ofr, pair) - glyph.width;
+    const size_t stride = (glyph.width + 1) / 2;
+    for (int row = 0; row < atlas.height; ++row) {
+      uint8_t *out = pixels + glyph.offset + ((size_t)row * stride);
+      for (int col = 0; col < glyph.width; ++col) {
+        const uint8_t coverage = coverageAt(scratch, glyphX + col, top + row);
+        out[col / 2] |= (col & 1) ? coverage : (uint8_t)(coverage << 4);
+      }
+    }
+  }
+
+  ofr.setDrawer(tft);
+  scratch.deleteSprite();
+  return true;
+}
+
+bool glyphAtlasAttach(GlyphAtlas &atlas, const PrebuiltAtlas *prebuilt, size_t count, const char *charset,
+                      unsigned fontSize) {
+  glyphAtlasFree(atlas);
+  const size_t glyphCount = strlen(charset);
+  if (glyphCount == 0 || glyphCount > GlyphAtlas::kMaxGlyphs) return false;
+
+  for (size_t i = 0; i < count; ++i) {
+    const PrebuiltAtlas &entry = prebuilt[i];
+    if (entry.fontSize != fontSize || strcmp(entry.charset, charset) != 0) continue;
+
+    for (size_t g = 0; g < glyphCount; ++g) {
+      const PrebuiltGlyph &source = entry.glyphs[g];
+      const int rightPad = source.advance - source.bearing - (int)source.width;
+      if (source.bearing < INT8_MIN || source.bearing > INT8_MAX || rightPad < INT8_MIN || rightPad > INT8_MAX) {
+        atlas = GlyphAtlas();
+        return false;
+      }
+      AtlasGlyph &glyph = atlas.glyphs[g];
+      glyph.code = source.code;
+      glyph.width = source.width;
+      glyph.leftPad = (int8_t)source.bearing;
+      glyph.rightPad = (int8_t)rightPad;
+      glyph.offset = source.offset;
+    }
+    atlas.glyphCount = glyphCount;
+    atlas.height = entry.height;
+    atlas.pixels = entry.pixels;
+    atlas.bytes = entry.bytes;
+    atlas.kerning = entry.kerning;
+    return true;
+  }
+  return false;
+}
+
+void glyphAtlasFree(GlyphAtlas &atlas) {
+  if (atlas.ownsPixels) free((void *)atlas.pixels);
+  atlas = GlyphAtlas();
+}
+
+int glyphAtlasTextWidth(const GlyphAtlas &atlas, const char *text) {
+  if (atlas.pixels == nullptr || text == nullptr || text[0] == '\0') return -1;
+
+  int width = 0;
+  const AtlasGlyph *previous = nullptr;
+  for (const char *c = text; *c != '\0'; ++c) {
+    const AtlasGlyph *glyph = findGlyph(atlas, *c);
+    if (glyph == nullptr) return -1;
+    if (previous != nullptr) width += previous->rightPad + glyph->leftPad + kerningBetween(atlas, previous, glyph);
+    width += glyph->width;
+    previous = glyph;
+  }
+  return width;
+}
+
+bool glyphAtlasDraw(const GlyphAtlas &atlas, TFT_eSPI &tft, const char *text, int x, int y, uint16_t color,
+                    uint16_t background) {
+  const size_t length = text != nullptr ? strlen(text) : 0;
+  const int width = glyphAtlasTextWidth(atlas, text);
+  if (width <= 0 || width > kMaxLineWidth || length > kMaxTextGlyphs) return false;
+  if (x < 0 || y < 0 || x + width > tft.width() || y + atlas.height > tft.height()) return false;
+
+  const AtlasGlyph *glyphs[kMaxTextGlyphs];
+  int glyphX[kMaxTextGlyphs];
+  int pen = 0;
+  for (size_t i = 0; i < length; ++i) {
+    glyphs[i] = findGlyph(atlas, text[i]);
+    if (i > 0) pen += glyphs[i - 1]->rightPad + glyphs[i]->leftPad + kerningBetween(atlas, glyphs[i - 1], glyphs[i]);
+    glyphX[i] = pen;
+    pen += glyphs[i]->width;
+  }
+
+  // Palette is pre-swapped to panel byte order so rows go out as-is.
+  uint16_t palette[16];
+  for (uint8_t coverage = 0; coverage < 16; ++coverage) {
+    const uint16_t c = blend565(background, color, coverage);
+    palette[coverage] = (uint16_t)((c >> 8) | (c << 8));
+  }
+
+  const bool swapBytes = tft.getSwapBytes();
+  tft.setSwapBytes(false);
+  tft.startWrite();
+  tft.setAddrWindow(x, y, width, atlas.height);
+  for (int row = 0; row < atlas.height; ++row) {
+    memset(gCoverageRow, 0, (size_t)width);
+    for (size_t i = 0; i < length; ++i) {
+      const AtlasGlyph &glyph = *glyphs[i];
+      const size_t stride = (glyph.width + 1) / 2;
+      const uint8_t *src = atlas.pixels + glyph.offset + ((size_t)row * stride);
+      uint8_t *dst = gCoverageRow + glyphX[i];
+      for (int col = 0; col < glyph.width; ++col) {
+        const uint8_t coverage = (col & 1) ? (src[col / 2] & 0x0F) : (src[col / 2] >> 4);
+        // Neighbouring glyphs may overlap by a column when a pad is negative.
+        if (coverage > dst[col]) dst[col] = coverage;
+      }
+    }
+    for (int col = 0; col < width; ++col) {
+      gColorRow[col] = palette[gCoverageRow[col]];
+    }
+    tft.pushPixels(gColorRow, (uint32_t)width);
+  }
+  tft.endWrite();
+  tft.setSwapBytes(swapBytes);
+  return true;
+}
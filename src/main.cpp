@@ -1,18 +1,33 @@
 #include <Arduino.h>
 #include <WiFi.h>
+#include <driver/gpio.h>
 #include <esp_idf_version.h>
+#include <esp_system.h>
 #include <esp_task_wdt.h>
+#include <hal/gpio_ll.h>
+#include <new>
+#include <soc/gpio_struct.h>
+#include <sys/time.h>
 #include <time.h>
 
 #include "app_types.h"
+#include "boot_profile.h"
+#include "button_tracker.h"
+#include "clock_drift.h"
 #include "display_ui.h"
 #include "logging_utils.h"
 #include "nordpool_ma_store.h"
 #include "nordpool_client.h"
+#include "power_utils.h"
 #include "price_cache.h"
 #include "price_state_utils.h"
+#include "render_queue.h"
+#include "rtc_state.h"
 #include "scheduling_utils.h"
+#include "snapshot_mailbox.h"
+#include "storage_utils.h"
 #include "time_utils.h"
+#include "timer_queue.h"
 #include "wifi_utils.h"
 
 constexpr uint32_t kWifiConnectTimeoutMs = 20000;
@@ -22,10 +37,25 @@ constexpr uint32_t kRetryOnErrorMaxMs = 1800000; // 30 min — backoff ceiling
 constexpr time_t kRetryDailyIfUnchangedSec = 10 * 60;
 constexpr uint32_t kResetHoldMs = 2000;
 constexpr uint32_t kResetPollIntervalMs = 50;
+constexpr uint32_t kButtonDebounceMs = 30;
 constexpr int kDailyFetchHour = 13;
 constexpr int kDailyFetchMinute = 0;
 constexpr uint32_t kWatchdogTimeoutMs = 60000; // 60 s — covers worst-case WiFi + 2 HTTP fetches
+constexpr uint8_t kMaxUnstableWarmBoots = 3;   // warm restores in a row that never got online
 constexpr char kActiveSourceLabel[] = "NORDPOOL";
+constexpr uint32_t kRenderFrameBudgetMs = 250;   // at most four redraws per second
+constexpr uint32_t kWallTimerMaxMs = 60UL * 60UL * 1000UL; // re-derive wall-clock deadlines at least hourly
+constexpr uint32_t kLoopMaxIdleMs = 10000;       // well inside the watchdog timeout
+// Network, parsing and flash next to the WiFi stack; drawing on the other core.
+constexpr BaseType_t kIngestTaskCore = 0;
+constexpr BaseType_t kRenderTaskCore = 1;
+constexpr uint32_t kIngestTaskStackBytes = 16384; // HTTP + JSON parsing, was the loop task's stack
+constexpr uint32_t kRenderTaskStackBytes = 12288; // OpenFontRender rasterizer
+constexpr UBaseType_t kTaskPriority = 1;
+constexpr uint32_t kRenderNotifySnapshot = 1 << 0;
+constexpr uint32_t kRenderNotifyClock = 1 << 1;
+constexpr uint32_t kRenderNotifyInvalidate = 1 << 2;
+constexpr uint32_t kRenderNotifyPortal = 1 << 3;
 
 #ifndef CONFIG_CLOCK_RESYNC_INTERVAL_SEC
 #define CONFIG_CLOCK_RESYNC_INTERVAL_SEC (6 * 60 * 60)
@@ -35,10 +65,33 @@ constexpr char kActiveSourceLabel[] = "NORDPOOL";
 #define CONFIG_CLOCK_RESYNC_RETRY_SEC (10 * 60)
 #endif
 
+#ifndef CONFIG_CLOCK_RESYNC_MIN_SEC
+#define CONFIG_CLOCK_RESYNC_MIN_SEC (60 * 60)
+#endif
+
+#ifndef CONFIG_CLOCK_RESYNC_MAX_SEC
+#define CONFIG_CLOCK_RESYNC_MAX_SEC (24 * 60 * 60)
+#endif
+
+#ifndef CONFIG_CLOCK_DRIFT_BUDGET_MS
+#define CONFIG_CLOCK_DRIFT_BUDGET_MS 1000
+#endif
+
+#ifndef CONFIG_STORAGE_BENCHMARK
+#define CONFIG_STORAGE_BENCHMARK 0
+#endif
+
 constexpr time_t kClockResyncIntervalSec =
     (CONFIG_CLOCK_RESYNC_INTERVAL_SEC > 0) ? (time_t)CONFIG_CLOCK_RESYNC_INTERVAL_SEC : (6 * 60 * 60);
 constexpr time_t kClockResyncRetrySec =
     (CONFIG_CLOCK_RESYNC_RETRY_SEC > 0) ? (time_t)CONFIG_CLOCK_RESYNC_RETRY_SEC : (10 * 60);
+// Adaptive bounds once drift has been measured; the interval above is used until then.
+constexpr time_t kClockResyncMinSec =
+    (CONFIG_CLOCK_RESYNC_MIN_SEC > 0) ? (time_t)CONFIG_CLOCK_RESYNC_MIN_SEC : (60 * 60);
+constexpr time_t kClockResyncMaxSec =
+    (CONFIG_CLOCK_RESYNC_MAX_SEC >= CONFIG_CLOCK_RESYNC_MIN_SEC) ? (time_t)CONFIG_CLOCK_RESYNC_MAX_SEC : kClockResyncMinSec;
+constexpr uint32_t kClockDriftBudgetMs =
+    (CONFIG_CLOCK_DRIFT_BUDGET_MS > 0) ? (uint32_t)CONFIG_CLOCK_DRIFT_BUDGET_MS : 1000;
 
 #ifndef CONFIG_RESET_PIN
 #define CONFIG_RESET_PIN -1
@@ -57,9 +110,44 @@ uint32_t gRetryIntervalMs = kRetryOnErrorMinMs;
 time_t gNextDailyFetch = 0;
 time_t gNextMinuteBoundary = 0;
 time_t gNextClockResync = 0;
+time_t gClockResyncIntervalSec = kClockResyncIntervalSec;
+ClockDriftTracker gClockDrift;
 bool gPendingCatchUpRecheck = false;
 bool gNeedsOnlineInit = false;
+bool gWarmRestored = false;
+bool gCacheBooted = false;
+bool gFirstPriceFrameLogged = false;
+bool gOnlineBootRecorded = false;
 bool gWatchdogInitialized = false;
+RenderQueue gRenderQueue(kRenderFrameBudgetMs);
+TimerQueue gTimers;
+bool gWifiConnected = false;
+// Until the tasks start, setup() draws directly on its own task.
+TaskHandle_t gIngestTask = nullptr;
+TaskHandle_t gRenderTask = nullptr;
+SnapshotMailbox<PriceState> gRenderSnapshots;
+
+// Work that needs a synced wall clock, run when the SNTP answer arrives.
+enum class AfterClockSync : uint8_t
+{
+  None = 0,
+  Fetch,
+  FinishCacheBoot,
+};
+AfterClockSync gAfterClockSync = AfterClockSync::None;
+
+// Everything loop() does is driven by one of these deadlines.
+enum LoopTimer : uint8_t
+{
+  kTimerButton = 0,
+  kTimerWifiCheck,
+  kTimerErrorRetry,
+  kTimerMinuteBoundary,
+  kTimerClockResync,
+  kTimerDailyFetch,
+  kTimerRender,
+  kTimerFlush,
+};
 
 constexpr int kConfigResetPin = CONFIG_RESET_PIN;
 constexpr int kConfigResetActiveLevel = CONFIG_RESET_ACTIVE_LEVEL;
@@ -71,6 +159,29 @@ bool resetButtonPressed()
   return digitalRead(kConfigResetPin) == kConfigResetActiveLevel;
 }
 
+ButtonTracker gResetButton(kButtonDebounceMs, kResetHoldMs);
+volatile bool gButtonEdge = false;
+// Set while the press interrupt is masked and the level is polled instead.
+volatile bool gButtonPolling = false;
+
+// Level-triggered on the active level so it also wakes light sleep, where
+// edges are lost. Masked here; serviceButton() re-arms it once released.
+// The GPIO ISR service is installed with ESP_INTR_FLAG_IRAM, so this runs
+// with the flash cache off during writes: gpio_intr_disable() lives in flash,
+// the inlined register write does not.
+void IRAM_ATTR onResetButtonActive()
+{
+  gpio_ll_intr_disable(&GPIO, (gpio_num_t)kConfigResetPin);
+  gButtonPolling = true;
+  gButtonEdge = true;
+  if (gIngestTask == nullptr)
+    return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(gIngestTask, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+// Only for the check at power-on, before anything else runs.
 bool resetButtonHeld(uint32_t holdMs = kResetHoldMs)
 {
   if (!resetButtonPressed())
@@ -87,12 +198,10 @@ bool resetButtonHeld(uint32_t holdMs = kResetHoldMs)
   return true;
 }
 
-void handleResetRequest()
+void performFactoryReset()
 {
-  if (!resetButtonHeld())
-    return;
-
   logf("Reset button held, clearing WiFi/config settings, price cache, and moving average");
+  rtcStateClear();
   if (!priceCacheClear())
   {
     logf("Price cache clear failed during reset");
@@ -123,24 +232,177 @@ void scheduleDailyFetch(time_t now)
   logNextFetch(gNextDailyFetch);
 }
 
+void requestRender(uint8_t reason)
+{
+  gRenderQueue.request(reason);
+}
+
+// Hands the render task its own copy of gState; the ingest task keeps
+// mutating gState while the copy is drawn.
+bool publishState()
+{
+  if (gRenderTask == nullptr)
+  {
+    displayDrawPrices(gState);
+    return true;
+  }
+
+  PriceState *snapshot = new (std::nothrow) PriceState(gState);
+  if (snapshot == nullptr)
+  {
+    logf("Render snapshot: no heap, retry next pass");
+    return false;
+  }
+  delete gRenderSnapshots.post(snapshot);
+  xTaskNotify(gRenderTask, kRenderNotifySnapshot, eSetBits);
+  return true;
+}
+
+void refreshClock()
+{
+  if (gRenderTask == nullptr)
+  {
+    displayRefreshClock();
+    return;
+  }
+  xTaskNotify(gRenderTask, kRenderNotifyClock, eSetBits);
+}
+
+// Short press: repaint the whole screen instead of only what changed.
+void requestFullRedraw()
+{
+  if (gRenderTask == nullptr)
+    displayInvalidate();
+  else
+    xTaskNotify(gRenderTask, kRenderNotifyInvalidate, eSetBits);
+  requestRender(kRenderUserInput);
+}
+
+void drawPortalInstructions()
+{
+  char apName[32];
+  wifiPortalApName(apName, sizeof(apName));
+  displayDrawWifiConfigPortal(apName, kWifiPortalTimeoutSec);
+}
+
+// Setup instructions for a portal opened after boot.
+void showPortalInstructions()
+{
+  if (gRenderTask == nullptr)
+    drawPortalInstructions();
+  else
+    xTaskNotify(gRenderTask, kRenderNotifyPortal, eSetBits);
+}
+
+void serviceButton(uint32_t nowMs)
+{
+  switch (gResetButton.update(resetButtonPressed(), nowMs))
+  {
+  case ButtonEvent::ShortPress:
+    logf("Button short press, full redraw");
+    requestFullRedraw();
+    break;
+  case ButtonEvent::LongPress:
+    performFactoryReset();
+    break;
+  case ButtonEvent::None:
+    break;
+  }
+
+  if (!gButtonPolling)
+    return;
+  uint32_t dueMs = 0;
+  if (gResetButton.rawPressed || gResetButton.stablePressed || gResetButton.nextCheckMs(dueMs))
+  {
+    powerHoldAwake(true);
+    return;
+  }
+  // Released and settled: a press from here on fires the interrupt again,
+  // even one that started before it was unmasked.
+  gButtonPolling = false;
+  powerHoldAwake(false);
+  gpio_intr_enable((gpio_num_t)kConfigResetPin);
+}
+
+void renderNow()
+{
+  const uint8_t reasons = gRenderQueue.take(millis());
+  if (!publishState())
+  {
+    gRenderQueue.request(reasons);
+    return;
+  }
+  char reasonText[40];
+  renderReasonsToString(reasons, reasonText, sizeof(reasonText));
+  logf(
+      "Render: reasons=%s requested=%u executed=%u",
+      reasonText,
+      (unsigned)gRenderQueue.requested,
+      (unsigned)gRenderQueue.executed);
+
+  if (!gFirstPriceFrameLogged && gState.ok)
+  {
+    // Time to first useful pixel, the number cache-first boot exists for.
+    gFirstPriceFrameLogged = true;
+    bootMark(BootPhase::FirstFrame);
+    logf("Boot first price frame: ms=%lu reasons=%s", (unsigned long)millis(), reasonText);
+  }
+}
+
+void serviceRender()
+{
+  if (gRenderQueue.due(millis()))
+  {
+    renderNow();
+  }
+}
+
+// Called before blocking work (network, NTP); showing the pending change
+// late by seconds is worse than exceeding the frame budget once.
+void flushRender()
+{
+  if (gRenderQueue.pending())
+  {
+    renderNow();
+  }
+}
+
+// Runs on the lwIP, WiFi event and portal tasks.
+void wakeIngestTask()
+{
+  if (gIngestTask != nullptr)
+    xTaskNotifyGive(gIngestTask);
+}
+
 void syncClockForSelectedArea()
 {
   const char *timezoneSpec = timezoneSpecForNordpoolArea(gSecrets.nordpoolArea);
   logf("Clock timezone selected: area=%s", gSecrets.nordpoolArea.c_str());
-  syncClock(timezoneSpec);
+  startClockSync(timezoneSpec, wakeIngestTask);
 }
 
+// Runs after every SNTP answer; a pending daily fetch or its retry, and a
+// schedule restored on a warm boot, are kept.
 void primeSchedulesFromNow(time_t now)
 {
-  scheduleDailyFetch(now);
+  if (gNextDailyFetch == 0)
+    scheduleDailyFetch(now);
   gNextMinuteBoundary = scheduleNextMinuteBoundary(now, kValidEpochMin);
-  gNextClockResync = scheduleAfter(now, kClockResyncIntervalSec, kValidEpochMin);
+  gNextClockResync = scheduleAfter(now, gClockResyncIntervalSec, kValidEpochMin);
 }
 
-void syncClockAndPrimeSchedules()
+void syncClockThen(AfterClockSync work)
 {
+  gAfterClockSync = work;
   syncClockForSelectedArea();
-  primeSchedulesFromNow(time(nullptr));
+}
+
+void mirrorStateToRtc()
+{
+  // After a warm restore the settings are not loaded until online init; keep the restored snapshot until then.
+  if (gSecrets.nordpoolArea.isEmpty())
+    return;
+  rtcStateSave(gState, timezoneSpecForNordpoolArea(gSecrets.nordpoolArea), gNextDailyFetch);
 }
 
 void initWatchdog()
@@ -202,7 +464,7 @@ void applyFetchedState(const PriceState &fetched)
   {
     gRetryIntervalMs = kRetryOnErrorMinMs;
     gState = fetched;
-    if (!priceCacheSave(gState))
+    if (!priceCacheQueueSave(gState))
     {
       logf("Price cache save failed");
     }
@@ -216,13 +478,15 @@ void applyFetchedState(const PriceState &fetched)
   {
     gState = fetched;
   }
-  displayDrawPrices(gState);
+  requestRender(kRenderFetched);
+  mirrorStateToRtc();
   gLastFetchMs = millis();
 }
 
 void fetchAndRender()
 {
   logf("Fetch+render start");
+  flushRender();
   fetchNordPoolPriceInfo(
       gSecrets.nordpoolApiUrl.c_str(),
       gSecrets.nordpoolArea.c_str(),
@@ -235,31 +499,6 @@ void fetchAndRender()
   logf("Fetch+render done");
 }
 
-bool applyLoadedCacheState(const PriceState &cacheState, const char *cacheLabel, bool saveBackToCache)
-{
-  if (cacheState.resolutionMinutes != gSecrets.nordpoolResolutionMinutes)
-  {
-    logf(
-        "Using %s cache with different resolution: cache=%u configured=%u",
-        cacheLabel,
-        (unsigned)cacheState.resolutionMinutes,
-        (unsigned)gSecrets.nordpoolResolutionMinutes);
-  }
-
-  gState = cacheState;
-  if (saveBackToCache && !priceCacheSave(gState))
-  {
-    logf("Price cache save failed");
-  }
-
-  logCurrentPriceCalculation(gState, gSecrets);
-
-  displayDrawPrices(gState);
-  logf("Loaded %s prices from cache: points=%u", cacheLabel, (unsigned)gState.count);
-  gPendingCatchUpRecheck = true;
-  return true;
-}
-
 bool prepareNordPoolCacheForCurrentFormula(PriceState &cacheState)
 {
   if (!cacheState.ok || cacheState.count == 0)
@@ -305,7 +544,15 @@ void updateCurrentIntervalFromClock(bool forceUpdate = false)
   gState.currentPrice = gState.points[idx].price;
   logf("Price slot update: idx=%d price=%.3f", idx, gState.currentPrice);
   logCurrentPriceCalculation(gState, gSecrets);
-  displayDrawPrices(gState);
+  requestRender(kRenderSlotChanged);
+}
+
+// Milliseconds since a wall-clock deadline; negative while still ahead.
+int64_t msPastWallDeadline(time_t deadline)
+{
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (((int64_t)tv.tv_sec - (int64_t)deadline) * 1000) + (tv.tv_usec / 1000);
 }
 
 void handleClockDrivenUpdates(time_t now)
@@ -316,24 +563,14 @@ void handleClockDrivenUpdates(time_t now)
 
   if (gNextClockResync == 0)
   {
-    gNextClockResync = scheduleAfter(currentNow, kClockResyncIntervalSec, kValidEpochMin);
+    gNextClockResync = scheduleAfter(currentNow, gClockResyncIntervalSec, kValidEpochMin);
   }
   if (currentNow >= gNextClockResync)
   {
     logf("Periodic clock resync trigger");
     syncClockForSelectedArea();
-    const time_t syncedNow = time(nullptr);
-    if (isValidClock(syncedNow, kValidEpochMin))
-    {
-      currentNow = syncedNow;
-      displayRefreshClock();
-      gNextMinuteBoundary = scheduleNextMinuteBoundary(currentNow, kValidEpochMin);
-      gNextClockResync = scheduleAfter(currentNow, kClockResyncIntervalSec, kValidEpochMin);
-    }
-    else
-    {
-      gNextClockResync = scheduleAfter(currentNow, kClockResyncRetrySec, kValidEpochMin);
-    }
+    // Pushed out to the full interval by serviceClockSync() once SNTP answers.
+    gNextClockResync = scheduleAfter(currentNow, kClockResyncRetrySec, kValidEpochMin);
   }
 
   if (gPendingCatchUpRecheck)
@@ -352,8 +589,15 @@ void handleClockDrivenUpdates(time_t now)
   }
   if (currentNow >= gNextMinuteBoundary)
   {
-    displayRefreshClock();
+    const int64_t lateMs = msPastWallDeadline(gNextMinuteBoundary);
+    // Catch-ups after a resync or a long blocking fetch are not wake latency.
+    if (lateMs >= 0 && lateMs < 60000)
+    {
+      powerNoteWakeLatency((uint32_t)lateMs);
+    }
+    refreshClock();
     updateCurrentIntervalFromClock();
+    mirrorStateToRtc();
     gNextMinuteBoundary = scheduleNextMinuteBoundary(currentNow, kValidEpochMin);
   }
 
@@ -363,6 +607,7 @@ void handleClockDrivenUpdates(time_t now)
   if (gNextDailyFetch != 0 && currentNow >= gNextDailyFetch)
   {
     logf("Daily 13:00 fetch trigger");
+    flushRender();
     fetchNordPoolPriceInfo(
         gSecrets.nordpoolApiUrl.c_str(),
         gSecrets.nordpoolArea.c_str(),
@@ -407,81 +652,89 @@ void handleClockDrivenUpdates(time_t now)
   }
 }
 
-void setup()
+bool isWarmReset(esp_reset_reason_t reason)
 {
-  Serial.begin(115200);
-  delay(200);
-  logf("Boot");
-  logf(
-      "Clock resync config: interval=%ld sec retry=%ld sec",
-      (long)kClockResyncIntervalSec,
-      (long)kClockResyncRetrySec);
+  return reason == ESP_RST_SW || reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+         reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT || reason == ESP_RST_DEEPSLEEP;
+}
 
-  if (kConfigResetPin >= 0)
+bool restoreWarmState()
+{
+  const esp_reset_reason_t reason = esp_reset_reason();
+  if (!isWarmReset(reason))
+    return false;
+  const uint8_t warmBoots = rtcStateNoteWarmBoot();
+  if (warmBoots > kMaxUnstableWarmBoots)
   {
-    if (kConfigResetActiveLevel == LOW)
-      pinMode(kConfigResetPin, INPUT_PULLUP);
-    else
-      pinMode(kConfigResetPin, INPUT_PULLDOWN);
+    // The restored state may be what keeps crashing us; start from flash.
+    logf("Warm reset (reason=%d) #%u without getting online, cold boot", (int)reason, (unsigned)warmBoots);
+    rtcStateClear();
+    return false;
   }
 
-  handleResetRequest();
-
-  displayInit();
+  char timezoneSpec[48];
+  time_t nextDailyFetch = 0;
+  if (!rtcStateRestore(gState, timezoneSpec, sizeof(timezoneSpec), nextDailyFetch))
+  {
+    logf("Warm reset (reason=%d) without valid RTC state, cold boot", (int)reason);
+    return false;
+  }
 
-  bool loadedFromCache = false;
-  bool loadedCurrentCache = false;
-  const bool wifiConnected = wifiConnectWithConfigPortal(gSecrets, kWifiPortalTimeoutSec);
+  applyTimezone(timezoneSpec);
+  gNextDailyFetch = isValidClock(nextDailyFetch, kValidEpochMin) ? nextDailyFetch : 0;
+  requestRender(kRenderWarmRestore);
+  updateCurrentIntervalFromClock(true);
+  logf("Warm reset (reason=%d), restored prices from RTC memory: points=%u", (int)reason, (unsigned)gState.count);
+  return true;
+}
 
-  if (!wifiConnected)
-  {
-    if (priceCacheLoadIfAvailable(kActiveSourceLabel, gCacheBuffer) &&
-        prepareNordPoolCacheForCurrentFormula(gCacheBuffer))
-    {
-      gState = gCacheBuffer;
-      gState.source = "no wifi";
-      displayDrawPrices(gState);
-      updateCurrentIntervalFromClock(true);
-      logf("No WiFi at boot, loaded prices from cache: points=%u", (unsigned)gState.count);
-      gNeedsOnlineInit = true;
-      initWatchdog();
-      return;
-    }
+// Draws the cached prices as they were saved, before WiFi or the portal.
+// On a cold boot there is no wall clock yet, so the saved current slot stays
+// highlighted until NTP lets finishCacheBoot() pick the real one.
+bool showCachedPrices()
+{
+  PriceCacheCoverage coverage;
+  if (!priceCacheLoad(kActiveSourceLabel, gCacheBuffer, coverage) ||
+      !prepareNordPoolCacheForCurrentFormula(gCacheBuffer))
+    return false;
+  bootMark(BootPhase::CacheLoad);
 
-    gState.ok = false;
-    gState.source = "no wifi";
-    gState.error = "no wifi";
-    displayDrawPrices(gState);
-    gNeedsOnlineInit = true;
-    initWatchdog();
-    return;
-  }
+  gState = gCacheBuffer;
+  requestRender(kRenderCacheLoaded);
+  updateCurrentIntervalFromClock(true);
+  logf("Showing cached prices before WiFi: points=%u", (unsigned)gState.count);
+  flushRender();
+  return true;
+}
 
-  syncClockAndPrimeSchedules();
+// Online half of a cache-first boot. The cached prices are still in gState
+// with the formula applied, so with the clock synced only their coverage is
+// classified; a fetch follows if it falls short.
+void finishCacheBoot()
+{
+  const time_t syncedNow = time(nullptr);
+  const bool hasCurrentSlot =
+      findCurrentPricePointIndex(gState, normalizeResolutionMinutes(gState.resolutionMinutes)) >= 0;
+  logf(
+      "Price cache coverage: current=%d today=%d tomorrow=%d",
+      hasCurrentSlot,
+      stateCoversLocalDay(gState, syncedNow, 0, kValidEpochMin),
+      stateCoversLocalDay(gState, syncedNow, 1, kValidEpochMin));
 
-  if (priceCacheLoadIfCurrent(kActiveSourceLabel, gCacheBuffer) &&
-      prepareNordPoolCacheForCurrentFormula(gCacheBuffer))
-  {
-    loadedFromCache = applyLoadedCacheState(gCacheBuffer, "current", true);
-    loadedCurrentCache = loadedFromCache;
-  }
-  else if (priceCacheLoadIfAvailable(kActiveSourceLabel, gCacheBuffer) &&
-           prepareNordPoolCacheForCurrentFormula(gCacheBuffer))
-  {
-    loadedFromCache = applyLoadedCacheState(gCacheBuffer, "available", false);
-  }
+  // Marked "no wifi" while offline; the prices themselves are the cache's.
+  gState.source = kActiveSourceLabel;
+  requestRender(kRenderCacheLoaded);
+  mirrorStateToRtc();
+  gPendingCatchUpRecheck = true;
 
-  if (!loadedFromCache || !loadedCurrentCache)
+  if (!hasCurrentSlot)
   {
-    if (loadedFromCache && !loadedCurrentCache)
-    {
-      logf("Available cache loaded without current interval coverage; fetching fresh prices now");
-    }
+    logf("Cached prices do not cover the current interval; fetching fresh prices now");
     fetchAndRender();
   }
 
   const time_t now = time(nullptr);
-  if (loadedFromCache && shouldCatchUpMissedDailyUpdate(now, gState, kDailyFetchHour, kDailyFetchMinute, kValidEpochMin))
+  if (shouldCatchUpMissedDailyUpdate(now, gState, kDailyFetchHour, kDailyFetchMinute, kValidEpochMin))
   {
     gNextDailyFetch = now;
     logf("Startup catch-up fetch scheduled immediately");
@@ -489,15 +742,59 @@ void setup()
   }
 
   updateCurrentIntervalFromClock(true);
-  initWatchdog();
 }
 
-void loop()
+// VAT and fixed cost only enter the price formula, so the prices already in
+// memory are recomputed from their raw values instead of refetched.
+void recalculateForFormulaChange()
 {
-  esp_task_wdt_reset();
-  handleResetRequest();
+  if (!gState.ok || gState.count == 0)
+    return;
+  if (!prepareNordPoolCacheForCurrentFormula(gState))
+  {
+    gWarmRestored = false;
+    gCacheBooted = false;
+    gNeedsOnlineInit = true;
+    return;
+  }
+  updateCurrentIntervalFromClock(true);
+  logCurrentPriceCalculation(gState, gSecrets);
+  requestRender(kRenderSettingsChanged);
+  mirrorStateToRtc();
+}
+
+void applyPortalChanges(uint8_t changes)
+{
+  if (changes & kPortalSourceSettingsChanged)
+  {
+    // Area can also change the timezone; redo the online init from scratch.
+    logf("Portal settings changed: refetch for area=%s", gSecrets.nordpoolArea.c_str());
+    gWarmRestored = false;
+    gCacheBooted = false;
+    gNeedsOnlineInit = true;
+  }
+  else if (changes & kPortalFormulaSettingsChanged)
+  {
+    logf("Portal settings changed: recalculating prices in memory");
+    recalculateForFormulaChange();
+  }
+  if (changes & kPortalClosed)
+  {
+    requestFullRedraw();
+  }
+  else if ((changes & kPortalOpened) && !gState.ok)
+  {
+    // The stored network did not answer and there are no prices to show.
+    showPortalInstructions();
+  }
+}
 
-  const bool wifiConnected = (WiFi.status() == WL_CONNECTED) || wifiReconnect(kWifiConnectTimeoutMs);
+// WiFi status, the config portal, reconnects and the deferred online init.
+void serviceConnectivity()
+{
+  applyPortalChanges(wifiPortalService(gSecrets));
+  const bool wifiConnected = wifiLinkService(millis()) == WifiLinkState::Connected;
+  gWifiConnected = wifiConnected;
   if (!wifiConnected)
   {
     if (gState.ok)
@@ -505,7 +802,7 @@ void loop()
       if (gState.source != "no wifi")
       {
         gState.source = "no wifi";
-        displayDrawPrices(gState);
+        requestRender(kRenderConnectivity);
       }
     }
     else
@@ -515,7 +812,7 @@ void loop()
       gState.error = "no wifi";
       if (needsRedraw)
       {
-        displayDrawPrices(gState);
+        requestRender(kRenderConnectivity);
       }
     }
   }
@@ -524,22 +821,377 @@ void loop()
   {
     logf("WiFi restored, running online init");
     gNeedsOnlineInit = false;
+    bootMark(BootPhase::WifiReady);
     loadAppSecrets(gSecrets);
-    syncClockAndPrimeSchedules();
-    fetchAndRender();
+    if (gWarmRestored && gState.ok)
+    {
+      // Keep the restored schedule; only refetch if tomorrow's prices are missing.
+      gWarmRestored = false;
+      syncClockForSelectedArea();
+      gPendingCatchUpRecheck = true;
+    }
+    else if (gCacheBooted && gState.ok)
+    {
+      gCacheBooted = false;
+      syncClockThen(AfterClockSync::FinishCacheBoot);
+    }
+    else
+    {
+      gWarmRestored = false;
+      gCacheBooted = false;
+      syncClockThen(AfterClockSync::Fetch);
+    }
   }
+}
 
-  const bool hasFetchError = !gState.error.isEmpty();
-  if (wifiConnected && (!gState.ok || hasFetchError) && millis() - gLastFetchMs >= gRetryIntervalMs)
+// Applies a completed SNTP sync: adapts the resync interval to the measured
+// drift, re-derives wall-clock deadlines and runs work that waited on it.
+void serviceClockSync()
+{
+  ClockSyncSample sample;
+  if (!takeClockSync(sample))
+    return;
+
+  const bool measured = gClockDrift.addSync(sample.ntpUs, sample.monotonicUs);
+  gClockResyncIntervalSec =
+      gClockDrift.resyncIntervalSec(kClockResyncIntervalSec, kClockResyncMinSec, kClockResyncMaxSec, kClockDriftBudgetMs);
+  logf(
+      "Clock sync done: now=%ld offset=%ldms drift=%.2fppm%s next=%ld sec",
+      (long)(sample.ntpUs / 1000000LL),
+      (long)gClockDrift.lastOffsetMs,
+      (double)gClockDrift.driftPpm,
+      measured ? "" : " (not measured)",
+      (long)gClockResyncIntervalSec);
+
+  const time_t now = time(nullptr);
+  if (!isValidClock(now, kValidEpochMin))
+    return;
+  bootMark(BootPhase::ClockSynced);
+  refreshClock();
+  primeSchedulesFromNow(now);
+  updateCurrentIntervalFromClock();
+
+  const AfterClockSync work = gAfterClockSync;
+  gAfterClockSync = AfterClockSync::None;
+  switch (work)
   {
-    logf("Retry fetch due to error state (interval=%us)", (unsigned)(gRetryIntervalMs / 1000));
+  case AfterClockSync::Fetch:
     fetchAndRender();
-    if (!gState.ok || !gState.error.isEmpty())
+    break;
+  case AfterClockSync::FinishCacheBoot:
+    finishCacheBoot();
+    break;
+  case AfterClockSync::None:
+    break;
+  }
+  if (!gOnlineBootRecorded)
+  {
+    gOnlineBootRecorded = true;
+    bootMark(BootPhase::OnlineReady);
+    bootCheckpoint("online");
+    rtcStateMarkStable();
+  }
+}
+
+bool needsErrorRetry()
+{
+  return gWifiConnected && (!gState.ok || !gState.error.isEmpty());
+}
+
+void serviceErrorRetry()
+{
+  if (!needsErrorRetry() || millis() - gLastFetchMs < gRetryIntervalMs)
+    return;
+
+  logf("Retry fetch due to error state (interval=%us)", (unsigned)(gRetryIntervalMs / 1000));
+  fetchAndRender();
+  if (!gState.ok || !gState.error.isEmpty())
+  {
+    gRetryIntervalMs = std::min(gRetryIntervalMs * 2, kRetryOnErrorMaxMs);
+    logf("Backoff: next retry in %us", (unsigned)(gRetryIntervalMs / 1000));
+  }
+}
+
+// millis() deadline for a wall-clock deadline, to the millisecond.
+uint32_t wallDeadlineToMs(time_t deadline, uint32_t nowMs)
+{
+  const int64_t remainingMs = -msPastWallDeadline(deadline);
+  if (remainingMs <= 0)
+    return nowMs;
+  return nowMs + (uint32_t)std::min(remainingMs, (int64_t)kWallTimerMaxMs);
+}
+
+void armWallTimer(uint8_t id, time_t deadline, uint32_t nowMs)
+{
+  // Unset schedules are filled in by handleClockDrivenUpdates() right away.
+  gTimers.schedule(id, deadline == 0 ? nowMs : wallDeadlineToMs(deadline, nowMs));
+}
+
+// Re-derives the deadlines of state-driven jobs after handlers ran; periodic
+// jobs re-arm themselves when they fire.
+void armLoopTimers(uint32_t nowMs)
+{
+  uint32_t buttonDueMs = 0;
+  const bool buttonDue = gResetButton.nextCheckMs(buttonDueMs);
+  if (gButtonPolling && (!buttonDue || (int32_t)(buttonDueMs - nowMs) > (int32_t)kResetPollIntervalMs))
+    gTimers.schedule(kTimerButton, nowMs + kResetPollIntervalMs);
+  else if (buttonDue)
+    gTimers.schedule(kTimerButton, buttonDueMs);
+  else
+    gTimers.cancel(kTimerButton);
+  uint32_t wifiDueMs = 0;
+  if (wifiLinkNextCheckMs(wifiDueMs))
+    gTimers.schedule(kTimerWifiCheck, wifiDueMs);
+  else
+    gTimers.cancel(kTimerWifiCheck);
+
+  if (needsErrorRetry())
+    gTimers.schedule(kTimerErrorRetry, gLastFetchMs + gRetryIntervalMs);
+  else
+    gTimers.cancel(kTimerErrorRetry);
+
+  if (isValidClock(time(nullptr), kValidEpochMin))
+  {
+    armWallTimer(kTimerMinuteBoundary, gNextMinuteBoundary, nowMs);
+    armWallTimer(kTimerClockResync, gNextClockResync, nowMs);
+    armWallTimer(kTimerDailyFetch, gPendingCatchUpRecheck ? 0 : gNextDailyFetch, nowMs);
+  }
+  else
+  {
+    // serviceClockSync() arms these when the first SNTP answer wakes the task.
+    gTimers.cancel(kTimerMinuteBoundary);
+    gTimers.cancel(kTimerClockResync);
+    gTimers.cancel(kTimerDailyFetch);
+  }
+
+  uint32_t dueMs = 0;
+  if (gRenderQueue.nextRenderMs(nowMs, dueMs))
+    gTimers.schedule(kTimerRender, dueMs);
+  else
+    gTimers.cancel(kTimerRender);
+
+  uint32_t cacheDueMs = 0;
+  uint32_t averageDueMs = 0;
+  const bool cacheDirty = priceCacheWriteStats().nextFlushMs(nowMs, cacheDueMs);
+  const bool averageDirty = nordPoolMovingAverageWriteStats().nextFlushMs(nowMs, averageDueMs);
+  if (cacheDirty || averageDirty)
+  {
+    if (!cacheDirty || (averageDirty && (int32_t)(averageDueMs - cacheDueMs) < 0))
+      cacheDueMs = averageDueMs;
+    gTimers.schedule(kTimerFlush, cacheDueMs);
+  }
+  else
+  {
+    gTimers.cancel(kTimerFlush);
+  }
+}
+
+void serviceDueTimers()
+{
+  esp_task_wdt_reset();
+
+  const uint32_t nowMs = millis();
+  uint32_t due = 0;
+  uint8_t id = 0;
+  while (gTimers.popDue(nowMs, id))
+  {
+    due |= 1UL << id;
+  }
+
+  // Same order as one pass of the old polling loop.
+  if ((due & (1UL << kTimerButton)) || gButtonEdge)
+  {
+    gButtonEdge = false;
+    serviceButton(nowMs);
+  }
+  // Link events wake the task; kTimerWifiCheck covers attempt deadlines and backoff.
+  serviceConnectivity();
+  serviceClockSync();
+  if (due & (1UL << kTimerErrorRetry))
+  {
+    serviceErrorRetry();
+  }
+  if (due & ((1UL << kTimerMinuteBoundary) | (1UL << kTimerClockResync) | (1UL << kTimerDailyFetch)))
+  {
+    handleClockDrivenUpdates(time(nullptr));
+  }
+  serviceRender();
+  if (due & (1UL << kTimerFlush))
+  {
+    priceCacheFlush();
+    nordPoolFlushMovingAverage();
+  }
+
+  armLoopTimers(millis());
+}
+
+void runIngestPass()
+{
+  {
+    PowerBusyScope busy;
+    serviceDueTimers();
+  }
+  powerLogSummary();
+
+  const uint32_t waitMs = gTimers.waitMs(millis(), kLoopMaxIdleMs);
+  if (waitMs > 0)
+  {
+    // Any task may xTaskNotifyGive() the ingest task to wake it early.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+  }
+}
+
+void ingestTask(void *)
+{
+  initWatchdog();
+  for (;;)
+  {
+    runIngestPass();
+  }
+}
+
+void renderTask(void *)
+{
+  for (;;)
+  {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+    if (bits & kRenderNotifyInvalidate)
     {
-      gRetryIntervalMs = std::min(gRetryIntervalMs * 2, kRetryOnErrorMaxMs);
-      logf("Backoff: next retry in %us", (unsigned)(gRetryIntervalMs / 1000));
+      displayInvalidate();
     }
+    if (bits & kRenderNotifySnapshot)
+    {
+      // Only the newest snapshot is drawn; older ones were freed by the producer.
+      PriceState *snapshot = gRenderSnapshots.take();
+      if (snapshot != nullptr)
+      {
+        PowerBusyScope busy;
+        displayDrawPrices(*snapshot);
+        delete snapshot;
+      }
+    }
+    if (bits & kRenderNotifyClock)
+    {
+      PowerBusyScope busy;
+      displayRefreshClock();
+    }
+    if (bits & kRenderNotifyPortal)
+    {
+      PowerBusyScope busy;
+      drawPortalInstructions();
+    }
+  }
+}
+
+// From here on the display belongs to the render task and gState to the
+// ingest task; they only meet in gRenderSnapshots.
+void startTasks()
+{
+  powerInit();
+  wifiLinkBegin(kWifiConnectTimeoutMs, wakeIngestTask);
+  if (xTaskCreatePinnedToCore(
+          renderTask, "render", kRenderTaskStackBytes, nullptr, kTaskPriority, &gRenderTask, kRenderTaskCore) != pdPASS)
+  {
+    gRenderTask = nullptr;
+    logf("Render task start failed, drawing from the ingest task");
+  }
+  if (xTaskCreatePinnedToCore(
+          ingestTask, "ingest", kIngestTaskStackBytes, nullptr, kTaskPriority, &gIngestTask, kIngestTaskCore) != pdPASS)
+  {
+    logf("Ingest task start failed, restarting");
+    delay(250);
+    ESP.restart();
   }
+  logf("Tasks started: ingest core=%d render core=%d", (int)kIngestTaskCore, (int)kRenderTaskCore);
+}
 
-  handleClockDrivenUpdates(time(nullptr));
+void setup()
+{
+  Serial.begin(115200);
+  delay(200);
+  bootMark(BootPhase::SerialReady);
+  logf("Boot");
+  logf(
+      "Clock resync config: interval=%ld sec retry=%ld sec adaptive=%ld-%ld sec budget=%lums",
+      (long)kClockResyncIntervalSec,
+      (long)kClockResyncRetrySec,
+      (long)kClockResyncMinSec,
+      (long)kClockResyncMaxSec,
+      (unsigned long)kClockDriftBudgetMs);
+
+  if (kConfigResetPin >= 0)
+  {
+    if (kConfigResetActiveLevel == LOW)
+      pinMode(kConfigResetPin, INPUT_PULLUP);
+    else
+      pinMode(kConfigResetPin, INPUT_PULLDOWN);
+    if (resetButtonHeld())
+      performFactoryReset();
+    attachInterrupt(
+        digitalPinToInterrupt(kConfigResetPin),
+        onResetButtonActive,
+        kConfigResetActiveLevel == LOW ? ONLOW : ONHIGH);
+    powerWakeOnPinLevel(kConfigResetPin, kConfigResetActiveLevel);
+  }
+
+  displayInit();
+
+  if (restoreWarmState())
+  {
+    // Settings, WiFi and NTP are brought up by the online init in loop().
+    gWarmRestored = true;
+    gNeedsOnlineInit = true;
+    flushRender();
+    bootMark(BootPhase::SetupDone);
+    bootCheckpoint("setup");
+    startTasks();
+    return;
+  }
+
+  if (CONFIG_STORAGE_BENCHMARK)
+  {
+    storageRunBenchmark();
+  }
+
+  // Paint the cached chart before WiFi and the config portal get a chance to
+  // block; clock sync and the fetch follow in the ingest task.
+  loadAppSecrets(gSecrets);
+  bootMark(BootPhase::Secrets);
+  gCacheBooted = showCachedPrices();
+  const bool wifiConnected = wifiConnectWithConfigPortal(gSecrets, kWifiPortalTimeoutSec, !gCacheBooted);
+  if (wifiConnected)
+    bootMark(BootPhase::WifiReady);
+
+  if (!wifiConnected)
+  {
+    if (gCacheBooted)
+    {
+      gState.source = "no wifi";
+      requestRender(kRenderConnectivity);
+      mirrorStateToRtc();
+      logf("No WiFi at boot, keeping cached prices: points=%u", (unsigned)gState.count);
+    }
+    else
+    {
+      gState.ok = false;
+      gState.source = "no wifi";
+      gState.error = "no wifi";
+      // Leave the setup instructions up; the portal closing repaints.
+      if (!wifiPortalActive())
+        requestRender(kRenderConnectivity);
+    }
+  }
+
+  gNeedsOnlineInit = true;
+  flushRender();
+  bootMark(BootPhase::SetupDone);
+  bootCheckpoint("setup");
+  startTasks();
+}
+
+void loop()
+{
+  // All work runs in the ingest and render tasks.
+  vTaskDelete(nullptr);
 }
@@ -7,10 +7,12 @@
 #include <string.h>
 #include <time.h>
 
+#include "checksum_utils.h"
 #include "logging_utils.h"
 #include "nordpool_ma_store.h"
 #include "nordpool_client.h"
 #include "time_utils.h"
+#include "write_coalescer.h"
 
 namespace {
 constexpr uint32_t kHttpTimeoutMs = 10000;
@@ -18,6 +20,28 @@ constexpr float kDefaultMovingAveragePerKwh = 1.0f;
 constexpr float kDefaultVatPercent = 25.0f;
 constexpr float kDefaultFixedCostPerKwh = 0.0f;
 constexpr float kCentsMultiplier = 100.0f;
+constexpr uint32_t kMovingAverageFlushMinIntervalMs = 60000;
+
+// Loaded from flash once; later recalculations reuse the in-memory copy.
+MovingAverageStore gMovingAverageStore;
+bool gMovingAverageLoaded = false;
+WriteCoalescer gMovingAverageWrites(kMovingAverageFlushMinIntervalMs);
+
+uint32_t movingAverageHash(const MovingAverageStore &store) {
+  return crc32Finish(crc32Update(kCrc32Init, (const uint8_t *)&store, sizeof(MovingAverageStore)));
+}
+
+MovingAverageStore &movingAverageStore() {
+  if (!gMovingAverageLoaded) {
+    if (loadMovingAverageStore(gMovingAverageStore)) {
+      gMovingAverageWrites.committed(movingAverageHash(gMovingAverageStore));
+    } else {
+      resetMovingAverageStore(gMovingAverageStore);
+    }
+    gMovingAverageLoaded = true;
+  }
+  return gMovingAverageStore;
+}
 
 float applyCustomPriceFormula(float rawPricePerKwh, float vatPercent, float fixedCostMinorPerKwh) {
   // Apply configured formula in minor units per kWh:
@@ -211,10 +235,7 @@ uint16_t applyMovingAverageToState(PriceState &state, float vatPercent, float fi
   state.resolutionMinutes = normalizeResolutionMinutes(state.resolutionMinutes);
   const uint16_t targetWindow = movingAverageWindowForResolution(state.resolutionMinutes);
 
-  MovingAverageStore store;
-  if (!loadMovingAverageStore(store)) {
-    resetMovingAverageStore(store);
-  }
+  MovingAverageStore &store = movingAverageStore();
   store.resolutionMinutes = normalizeResolutionMinutes(store.resolutionMinutes);
   if (store.resolutionMinutes != state.resolutionMinutes || store.windowSamples != targetWindow) {
     resetMovingAverageStore(store);
@@ -222,9 +243,8 @@ uint16_t applyMovingAverageToState(PriceState &state, float vatPercent, float fi
     store.windowSamples = targetWindow;
   }
 
-  const bool historyChanged = updateHistoryFromPoints(state, store);
-  if (historyChanged && !saveMovingAverageStore(store)) {
-    logf("Nord Pool moving average save failed");
+  if (updateHistoryFromPoints(state, store)) {
+    gMovingAverageWrites.markIfChanged(movingAverageHash(store));
   }
 
   float movingAvgRawPerKwh =
@@ -383,6 +403,26 @@ void nordPoolPreupdateMovingAverageFromPriceInfo(PriceState &state, float vatPer
   (void)applyMovingAverageToState(state, normalizedVatPercent, normalizedFixedCostPerKwh);
 }
 
+void nordPoolFlushMovingAverage() {
+  const uint32_t nowMs = millis();
+  if (!gMovingAverageWrites.flushDue(nowMs)) return;
+
+  const bool saved = saveMovingAverageStore(gMovingAverageStore);
+  gMovingAverageWrites.flushed(saved, nowMs);
+  if (!saved) {
+    logf("Nord Pool moving average save failed");
+    return;
+  }
+  logf(
+      "Nord Pool moving average flushed: writes=%u avoided=%u",
+      (unsigned)gMovingAverageWrites.writesPerformed,
+      (unsigned)gMovingAverageWrites.writesAvoided);
+}
+
+const WriteCoalescer &nordPoolMovingAverageWriteStats() {
+  return gMovingAverageWrites;
+}
+
 bool nordPoolRecalculatePricesFromRaw(PriceState &state, float vatPercent, float fixedCostPerKwh) {
   if (state.count == 0) return false;
 
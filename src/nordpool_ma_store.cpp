@@ -1,26 +1,11 @@
 #include "nordpool_ma_store.h"
 
-#include <FS.h>
-#include <SPIFFS.h>
-
+#include "atomic_store.h"
 #include "logging_utils.h"
+#include "storage_utils.h"
 
 namespace {
 constexpr char kMovingAveragePath[] = "/nordpool_ma.bin";
-
-bool ensureSpiffsMounted() {
-  static bool attempted = false;
-  static bool mounted = false;
-  if (!attempted) {
-    attempted = true;
-    mounted = SPIFFS.begin(true);
-    logf("SPIFFS mount: %s", mounted ? "ok" : "failed");
-    if (mounted) {
-      logf("SPIFFS info: used=%u total=%u", (unsigned)SPIFFS.usedBytes(), (unsigned)SPIFFS.totalBytes());
-    }
-  }
-  return mounted;
-}
 }  // namespace
 
 void resetMovingAverageStore(MovingAverageStore &store) {
@@ -28,12 +13,13 @@ void resetMovingAverageStore(MovingAverageStore &store) {
 }
 
 bool loadMovingAverageStore(MovingAverageStore &store) {
-  if (!ensureSpiffsMounted()) return false;
+  if (!storageMount()) return false;
 
-  File file = SPIFFS.open(kMovingAveragePath, FILE_READ);
-  if (!file) return false;
+  File file;
+  AtomicStoreEntry entry;
+  if (!atomicStoreOpenLatest(storageFs(), kMovingAveragePath, file, entry)) return false;
 
-  if ((size_t)file.size() != sizeof(MovingAverageStore)) {
+  if (entry.payloadLength != sizeof(MovingAverageStore)) {
     file.close();
     return false;
   }
@@ -49,21 +35,16 @@ bool loadMovingAverageStore(MovingAverageStore &store) {
 }
 
 bool saveMovingAverageStore(const MovingAverageStore &store) {
-  if (!ensureSpiffsMounted()) return false;
-
-  File file = SPIFFS.open(kMovingAveragePath, FILE_WRITE);
-  if (!file) return false;
+  if (!storageMount()) return false;
 
-  const size_t written = file.write((const uint8_t *)&store, sizeof(MovingAverageStore));
-  file.flush();
-  file.close();
-  return written == sizeof(MovingAverageStore);
+  return atomicStoreWrite(storageFs(), kMovingAveragePath, [&store](Print &out) {
+    return out.write((const uint8_t *)&store, sizeof(MovingAverageStore)) == sizeof(MovingAverageStore);
+  });
 }
 
 bool clearMovingAverageStore() {
-  if (!ensureSpiffsMounted()) return false;
-  if (!SPIFFS.exists(kMovingAveragePath)) return true;
-  if (!SPIFFS.remove(kMovingAveragePath)) {
+  if (!storageMount()) return false;
+  if (!atomicStoreRemove(storageFs(), kMovingAveragePath)) {
     logf("Nord Pool moving average clear failed");
     return false;
   }
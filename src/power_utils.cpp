@@ -0,0 +1,135 @@
+#include "power_utils.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <driver/gpio.h>
+#include <atomic>
+#include <esp_err.h>
+#include <esp_idf_version.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+
+#include "logging_utils.h"
+
+#ifndef CONFIG_POWER_SAVE
+#define CONFIG_POWER_SAVE 1
+#endif
+
+namespace {
+// XTAL frequency; Wi-Fi and the SPI panel take the APB lock they need.
+constexpr int kMinCpuFreqMhz = 40;
+constexpr int64_t kSummaryIntervalUs = 15LL * 60LL * 1000000LL;
+
+esp_pm_lock_handle_t gBusyLock = nullptr;
+esp_pm_lock_handle_t gAwakeLock = nullptr;
+bool gAwakeHeld = false;
+// Written by the ingest and render tasks.
+std::atomic<uint32_t> gBusyUs{0};
+std::atomic<uint32_t> gBusyScopes{0};
+uint32_t gLatencySamples = 0;
+uint32_t gLatencyTotalMs = 0;
+uint32_t gLatencyMaxMs = 0;
+int64_t gSummaryStartUs = 0;
+
+esp_err_t configurePm(int maxFreqMhz, bool lightSleep) {
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_pm_config_t config = {};
+#else
+  esp_pm_config_esp32_t config = {};
+#endif
+  config.max_freq_mhz = maxFreqMhz;
+  config.min_freq_mhz = kMinCpuFreqMhz;
+  config.light_sleep_enable = lightSleep;
+  return esp_pm_configure(&config);
+}
+}  // namespace
+
+void powerInit() {
+  gSummaryStartUs = esp_timer_get_time();
+  if (!CONFIG_POWER_SAVE) {
+    logf("Power save: off");
+    return;
+  }
+
+  const int maxFreqMhz = (int)getCpuFrequencyMhz();
+  if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "busy", &gBusyLock) != ESP_OK) {
+    gBusyLock = nullptr;
+  }
+  if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "awake", &gAwakeLock) != ESP_OK) {
+    gAwakeLock = nullptr;
+  }
+
+  const char *mode = "dfs+light-sleep";
+  esp_err_t err = configurePm(maxFreqMhz, true);
+  if (err == ESP_ERR_NOT_SUPPORTED) {
+    // Framework built without tickless idle.
+    mode = "dfs";
+    err = configurePm(maxFreqMhz, false);
+  }
+  if (err != ESP_OK) {
+    mode = "off";
+  }
+
+  // Applied now if the station is up, otherwise when it starts.
+  WiFi.setSleep(WIFI_PS_MIN_MODEM);
+  logf(
+      "Power save: mode=%s cpu=%d-%dMHz modem=dtim err=%d",
+      mode,
+      kMinCpuFreqMhz,
+      maxFreqMhz,
+      (int)err);
+}
+
+PowerBusyScope::PowerBusyScope() : startUs(esp_timer_get_time()) {
+  if (gBusyLock != nullptr) esp_pm_lock_acquire(gBusyLock);
+}
+
+PowerBusyScope::~PowerBusyScope() {
+  if (gBusyLock != nullptr) esp_pm_lock_release(gBusyLock);
+  gBusyUs += (uint32_t)(esp_timer_get_time() - startUs);
+  ++gBusyScopes;
+}
+
+void powerWakeOnPinLevel(int pin, int level) {
+  // GPIO edges are not latched while the digital domain is clock-gated.
+  gpio_wakeup_enable((gpio_num_t)pin, level == LOW ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+}
+
+void powerHoldAwake(bool hold) {
+  if (gAwakeLock == nullptr || hold == gAwakeHeld) return;
+  gAwakeHeld = hold;
+  if (hold) {
+    esp_pm_lock_acquire(gAwakeLock);
+  } else {
+    esp_pm_lock_release(gAwakeLock);
+  }
+}
+
+void powerNoteWakeLatency(uint32_t latencyMs) {
+  ++gLatencySamples;
+  gLatencyTotalMs += latencyMs;
+  if (latencyMs > gLatencyMaxMs) gLatencyMaxMs = latencyMs;
+}
+
+void powerLogSummary() {
+  const int64_t nowUs = esp_timer_get_time();
+  const int64_t elapsedUs = nowUs - gSummaryStartUs;
+  if (elapsedUs < kSummaryIntervalUs) return;
+
+  const uint32_t busyUs = gBusyUs.exchange(0);
+  const uint32_t scopes = gBusyScopes.exchange(0);
+  logf(
+      "Power: busy=%lums of %lums duty=%.2f%% wakes=%u latency avg=%ums max=%ums",
+      (unsigned long)(busyUs / 1000),
+      (unsigned long)(elapsedUs / 1000),
+      (double)busyUs * 100.0 / (double)elapsedUs,
+      (unsigned)scopes,
+      (unsigned)(gLatencySamples > 0 ? gLatencyTotalMs / gLatencySamples : 0),
+      (unsigned)gLatencyMaxMs);
+  gLatencySamples = 0;
+  gLatencyTotalMs = 0;
+  gLatencyMaxMs = 0;
+  gSummaryStartUs = nowUs;
+}
@@ -1,26 +1,23 @@
 #include <ArduinoJson.h>
-#include <FS.h>
-#include <SPIFFS.h>
 #include <string.h>
+#include <utility>
 
+#include "atomic_store.h"
+#include "checksum_utils.h"
 #include "logging_utils.h"
 #include "price_cache.h"
+#include "storage_utils.h"
 #include "time_utils.h"
+#include "write_coalescer.h"
 
 namespace {
 constexpr char kCachePath[] = "/price_cache.json";
 constexpr int kCacheVersion = 2;
+constexpr uint32_t kCacheFlushMinIntervalMs = 60000;
 
-bool ensureSpiffsMounted() {
-  static bool attempted = false;
-  static bool mounted = false;
-  if (!attempted) {
-    attempted = true;
-    mounted = SPIFFS.begin(true);
-    logf("Price cache SPIFFS mount: %s", mounted ? "ok" : "failed");
-  }
-  return mounted;
-}
+WriteCoalescer gCacheWrites(kCacheFlushMinIntervalMs);
+// Serialized JSON waiting for priceCacheFlush(); empty when nothing is pending.
+String gPendingPayload;
 
 void applyCurrentFromIndex(PriceState &state, int idx) {
   if (idx < 0 || idx >= (int)state.count) return;
@@ -30,13 +27,19 @@ void applyCurrentFromIndex(PriceState &state, int idx) {
   state.currentLevel = state.points[idx].level;
   state.currentPrice = state.points[idx].price;
 }
+}  // namespace
 
-bool priceCacheLoadInternal(const char *expectedSource, bool requireCurrentInterval, PriceState &out) {
+bool priceCacheLoad(const char *expectedSource, PriceState &out, PriceCacheCoverage &coverage) {
   out = PriceState();
-  if (!ensureSpiffsMounted()) return false;
-
-  File file = SPIFFS.open(kCachePath, FILE_READ);
-  if (!file) return false;
+  coverage = PriceCacheCoverage();
+  if (!storageMount()) return false;
+
+  File file;
+  AtomicStoreEntry entry;
+  if (!atomicStoreOpenLatest(storageFs(), kCachePath, file, entry)) return false;
+  if (entry.hasCrc) {
+    gCacheWrites.committed(entry.crc);
+  }
 
   JsonDocument doc;
   const DeserializationError err = deserializeJson(doc, file);
@@ -84,23 +87,20 @@ bool priceCacheLoadInternal(const char *expectedSource, bool requireCurrentInter
   if (out.count == 0) return false;
 
   int idx = findCurrentPricePointIndex(out, out.resolutionMinutes);
-  if (idx < 0) {
-    if (requireCurrentInterval) {
-      // Cache exists but does not cover current interval.
-      return false;
-    }
-    idx = 0;
-  }
+  coverage.hasCurrentSlot = idx >= 0;
+  if (idx < 0) idx = 0;
 
   applyCurrentFromIndex(out, idx);
   out.ok = true;
+
+  const time_t now = time(nullptr);
+  coverage.hasToday = stateCoversLocalDay(out, now, 0, kValidEpochMin);
+  coverage.hasTomorrow = stateCoversLocalDay(out, now, 1, kValidEpochMin);
   return true;
 }
-}  // namespace
 
-bool priceCacheSave(const PriceState &state) {
+bool priceCacheQueueSave(const PriceState &state) {
   if (!state.ok || state.count == 0) return false;
-  if (!ensureSpiffsMounted()) return false;
 
   JsonDocument doc;
   doc["version"] = kCacheVersion;
@@ -121,34 +121,49 @@ bool priceCacheSave(const PriceState &state) {
     }
   }
 
-  File file = SPIFFS.open(kCachePath, FILE_WRITE);
-  if (!file) {
-    logf("Price cache save failed: open");
+  String payload;
+  if (serializeJson(doc, payload) == 0) {
+    logf("Price cache save failed: serialize");
     return false;
   }
 
-  if (serializeJson(doc, file) == 0) {
-    file.close();
-    logf("Price cache save failed: serialize");
-    return false;
+  const uint32_t hash = crc32Finish(crc32Update(kCrc32Init, (const uint8_t *)payload.c_str(), payload.length()));
+  if (gCacheWrites.markIfChanged(hash)) {
+    gPendingPayload = std::move(payload);
+  } else if (!gCacheWrites.dirty) {
+    gPendingPayload = String();
   }
-  file.flush();
-  file.close();
   return true;
 }
 
-bool priceCacheLoadIfCurrent(const char *expectedSource, PriceState &out) {
-  return priceCacheLoadInternal(expectedSource, true, out);
+void priceCacheFlush() {
+  const uint32_t nowMs = millis();
+  if (!gCacheWrites.flushDue(nowMs)) return;
+
+  const bool saved = storageMount() && atomicStoreWrite(storageFs(), kCachePath, [](Print &out) {
+    return out.write((const uint8_t *)gPendingPayload.c_str(), gPendingPayload.length()) == gPendingPayload.length();
+  });
+  gCacheWrites.flushed(saved, nowMs);
+  if (!saved) {
+    logf("Price cache save failed: commit");
+    return;
+  }
+  gPendingPayload = String();
+  logf(
+      "Price cache flushed: writes=%u avoided=%u",
+      (unsigned)gCacheWrites.writesPerformed,
+      (unsigned)gCacheWrites.writesAvoided);
 }
 
-bool priceCacheLoadIfAvailable(const char *expectedSource, PriceState &out) {
-  return priceCacheLoadInternal(expectedSource, false, out);
+const WriteCoalescer &priceCacheWriteStats() {
+  return gCacheWrites;
 }
 
 bool priceCacheClear() {
-  if (!ensureSpiffsMounted()) return false;
-  if (!SPIFFS.exists(kCachePath)) return true;
-  if (!SPIFFS.remove(kCachePath)) {
+  gCacheWrites.reset();
+  gPendingPayload = String();
+  if (!storageMount()) return false;
+  if (!atomicStoreRemove(storageFs(), kCachePath)) {
     logf("Price cache clear failed");
     return false;
   }
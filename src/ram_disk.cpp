@@ -0,0 +1,222 @@
+#include "ram_disk.h"
+
+#include <FSImpl.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef CONFIG_STORAGE_RAMDISK_BYTES
+#define CONFIG_STORAGE_RAMDISK_BYTES (256 * 1024)
+#endif
+
+namespace {
+constexpr size_t kPageBytes = 256;
+
+using FileData = std::shared_ptr<std::vector<uint8_t>>;
+
+size_t pagesFor(size_t bytes) {
+  return bytes == 0 ? 1 : (bytes + kPageBytes - 1) / kPageBytes;
+}
+}  // namespace
+
+struct RamDiskVolume : public fs::FSImpl {
+  explicit RamDiskVolume(size_t capacity) : capacity(capacity) {}
+
+  size_t capacity;
+  bool mounted = false;
+  size_t written = 0;
+  bool powerCutArmed = false;
+  bool powerLost = false;
+  size_t powerBudget = 0;
+  std::map<std::string, FileData> files;
+
+  size_t usedBytes() const {
+    size_t pages = 0;
+    for (const auto &file : files) pages += pagesFor(file.second->size());
+    return pages * kPageBytes;
+  }
+
+  // Bytes `data` can still grow by before the volume is full.
+  size_t roomFor(const FileData &data) const {
+    size_t others = 0;
+    for (const auto &file : files) {
+      if (file.second != data) others += pagesFor(file.second->size()) * kPageBytes;
+    }
+    const size_t limit = capacity > others ? capacity - others : 0;
+    return limit > data->size() ? limit - data->size() : 0;
+  }
+
+  // Counts `size` programmed bytes; returns how many land before a pending power cut.
+  size_t program(size_t size) {
+    if (powerLost) return 0;
+    if (powerCutArmed) {
+      if (size > powerBudget) {
+        size = powerBudget;
+        powerLost = true;
+      }
+      powerBudget -= size;
+    }
+    written += size;
+    return size;
+  }
+
+  bool writable() const { return mounted && !powerLost; }
+
+  fs::FileImplPtr open(const char *path, const char *mode, const bool create) override;
+
+  bool exists(const char *path) override { return mounted && files.count(path) != 0; }
+
+  bool rename(const char *pathFrom, const char *pathTo) override {
+    auto from = files.find(pathFrom);
+    if (!writable() || from == files.end()) return false;
+    FileData data = from->second;
+    files.erase(from);
+    files[pathTo] = data;
+    return true;
+  }
+
+  bool remove(const char *path) override { return writable() && files.erase(path) != 0; }
+
+  // Flat namespace, like SPIFFS.
+  bool mkdir(const char *) override { return false; }
+  bool rmdir(const char *) override { return false; }
+};
+
+namespace {
+class RamDiskFile : public fs::FileImpl {
+ public:
+  RamDiskFile(RamDiskVolume &volume, const char *path, FileData data, bool canRead, bool canWrite)
+      : volume(volume), filePath(path), data(data), canRead(canRead), canWrite(canWrite) {}
+
+  size_t write(const uint8_t *buf, size_t size) override {
+    if (!isOpen || !canWrite || !volume.mounted) return 0;
+    // Overwrites inside the file always fit; growth is limited by free pages.
+    const size_t take = volume.program(std::min(size, (data->size() - pos) + volume.roomFor(data)));
+    if (pos + take > data->size()) data->resize(pos + take);
+    std::copy(buf, buf + take, data->begin() + (long)pos);
+    pos += take;
+    return take;
+  }
+
+  size_t read(uint8_t *buf, size_t size) override {
+    if (!isOpen || !canRead || pos >= data->size()) return 0;
+    const size_t got = std::min(size, data->size() - pos);
+    std::copy(data->begin() + (long)pos, data->begin() + (long)(pos + got), buf);
+    pos += got;
+    return got;
+  }
+
+  void flush() override {}
+
+  bool seek(uint32_t offset, fs::SeekMode mode) override {
+    size_t target = offset;
+    if (mode == fs::SeekCur) target = pos + offset;
+    if (mode == fs::SeekEnd) target = data->size() + offset;
+    if (!isOpen || target > data->size()) return false;
+    pos = target;
+    return true;
+  }
+
+  size_t position() const override { return pos; }
+  size_t size() const override { return data->size(); }
+  bool setBufferSize(size_t) override { return true; }
+  void close() override { isOpen = false; }
+  time_t getLastWrite() override { return 0; }
+  const char *path() const override { return filePath.c_str(); }
+
+  const char *name() const override {
+    const size_t slash = filePath.rfind('/');
+    return filePath.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+  }
+
+  bool isDirectory() override { return false; }
+  fs::FileImplPtr openNextFile(const char *) override { return fs::FileImplPtr(); }
+  bool seekDir(long) override { return false; }
+  String getNextFileName() override { return String(); }
+  String getNextFileName(bool *isDir) override {
+    if (isDir != nullptr) *isDir = false;
+    return String();
+  }
+  void rewindDirectory() override {}
+  operator bool() override { return isOpen; }
+
+ private:
+  RamDiskVolume &volume;
+  std::string filePath;
+  FileData data;
+  bool canRead;
+  bool canWrite;
+  bool isOpen = true;
+  size_t pos = 0;
+};
+}  // namespace
+
+fs::FileImplPtr RamDiskVolume::open(const char *path, const char *mode, const bool) {
+  if (!mounted || path == nullptr || mode == nullptr) return fs::FileImplPtr();
+
+  const bool update = mode[1] == '+';
+  auto it = files.find(path);
+  if (mode[0] == 'r') {
+    if (it == files.end()) return fs::FileImplPtr();
+    return std::make_shared<RamDiskFile>(*this, path, it->second, true, update && writable());
+  }
+  if (!writable()) return fs::FileImplPtr();
+
+  if (it == files.end()) {
+    if (usedBytes() + kPageBytes > capacity) return fs::FileImplPtr();
+    it = files.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+  } else if (mode[0] == 'w') {
+    // Truncation replaces the data, so readers of the old file keep theirs.
+    it->second = std::make_shared<std::vector<uint8_t>>();
+  }
+  auto file = std::make_shared<RamDiskFile>(*this, path, it->second, update, true);
+  if (mode[0] == 'a') file->seek(0, fs::SeekEnd);
+  return file;
+}
+
+RamDiskFS::RamDiskFS(size_t capacityBytes) : fs::FS(fs::FSImplPtr()), volume(new RamDiskVolume(capacityBytes)) {
+  _impl = fs::FSImplPtr(volume);
+}
+
+bool RamDiskFS::begin(bool) {
+  volume->mounted = true;
+  volume->written = 0;
+  return true;
+}
+
+void RamDiskFS::end() {
+  volume->mounted = false;
+}
+
+bool RamDiskFS::format() {
+  volume->files.clear();
+  volume->written = 0;
+  return true;
+}
+
+size_t RamDiskFS::totalBytes() {
+  return volume->capacity;
+}
+
+size_t RamDiskFS::usedBytes() {
+  return volume->usedBytes();
+}
+
+size_t RamDiskFS::bytesWritten() {
+  return volume->written;
+}
+
+void RamDiskFS::cutPowerAfter(size_t bytes) {
+  volume->powerCutArmed = true;
+  volume->powerLost = false;
+  volume->powerBudget = bytes;
+}
+
+void RamDiskFS::restorePower() {
+  volume->powerCutArmed = false;
+  volume->powerLost = false;
+}
+
+RamDiskFS RamDisk(CONFIG_STORAGE_RAMDISK_BYTES);
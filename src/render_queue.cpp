@@ -0,0 +1,58 @@
+#include "render_queue.h"
+
+#include <stdio.h>
+
+namespace {
+struct ReasonName {
+  uint8_t reason;
+  const char *name;
+};
+
+constexpr ReasonName kReasonNames[] = {
+    {kRenderWarmRestore, "rtc"},
+    {kRenderCacheLoaded, "cache"},
+    {kRenderFetched, "fetch"},
+    {kRenderSlotChanged, "slot"},
+    {kRenderConnectivity, "wifi"},
+    {kRenderUserInput, "button"},
+    {kRenderSettingsChanged, "settings"},
+};
+}  // namespace
+
+void RenderQueue::request(uint8_t reason) {
+  pendingReasons |= reason;
+  ++requested;
+}
+
+bool RenderQueue::due(uint32_t nowMs) const {
+  if (!pending()) return false;
+  if (!hasRendered) return true;
+  return nowMs - lastRenderMs >= frameBudgetMs;
+}
+
+bool RenderQueue::nextRenderMs(uint32_t nowMs, uint32_t &dueMs) const {
+  if (!pending()) return false;
+  dueMs = hasRendered ? lastRenderMs + frameBudgetMs : nowMs;
+  return true;
+}
+
+uint8_t RenderQueue::take(uint32_t nowMs) {
+  const uint8_t reasons = pendingReasons;
+  pendingReasons = 0;
+  hasRendered = true;
+  lastRenderMs = nowMs;
+  ++executed;
+  return reasons;
+}
+
+void renderReasonsToString(uint8_t reasons, char *out, size_t outSize) {
+  if (outSize == 0) return;
+  out[0] = '\0';
+  size_t used = 0;
+  for (const ReasonName &entry : kReasonNames) {
+    if ((reasons & entry.reason) == 0) continue;
+    const int written = snprintf(out + used, outSize - used, "%s%s", used > 0 ? "|" : "", entry.name);
+    if (written < 0 || (size_t)written >= outSize - used) break;
+    used += (size_t)written;
+  }
+}
@@ -0,0 +1,178 @@
+#include "rtc_state.h"
+
+#include <esp_attr.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "checksum_utils.h"
+
+namespace {
+constexpr uint32_t kRtcStateMagic = 0x52544353;  // "RTCS"
+constexpr uint32_t kWarmBootMagic = 0x5254424f;  // "RTBO"
+constexpr uint16_t kRtcStateVersion = 1;
+constexpr uint8_t kRawPriceFlag = 0x80;
+constexpr const char *kLevelNames[] = {"UNKNOWN", "VERY_CHEAP", "CHEAP", "NORMAL", "EXPENSIVE", "VERY_EXPENSIVE"};
+constexpr size_t kLevelCount = sizeof(kLevelNames) / sizeof(kLevelNames[0]);
+
+struct RtcPoint {
+  uint32_t packedStart;  // YYYY-MM-DDTHH:MM as 12/4/5/5/6 bit fields
+  float price;
+  float rawPrice;
+};
+
+struct RtcSnapshot {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint16_t resolutionMinutes;
+  int16_t currentIndex;
+  uint8_t hasRunningAverage;
+  float runningAverage;
+  int64_t nextDailyFetch;
+  char source[12];
+  char currency[8];
+  char timezone[48];
+  uint8_t levels[kMaxPoints];  // level index, kRawPriceFlag when rawPrice is set
+  RtcPoint points[kMaxPoints];
+  uint32_t crc;
+};
+static_assert(sizeof(RtcSnapshot) < 4096, "RTC slow memory is shared; keep the snapshot small");
+
+RTC_NOINIT_ATTR RtcSnapshot gSnapshot;
+
+// Separate from the snapshot so clearing or rewriting it keeps the count.
+struct RtcWarmBoots {
+  uint32_t magic;
+  uint32_t count;
+};
+
+RTC_NOINIT_ATTR RtcWarmBoots gWarmBoots;
+
+// Covers everything between magic and crc; magic is written last as the commit marker.
+uint32_t snapshotCrc(const RtcSnapshot &snapshot) {
+  const uint8_t *begin = (const uint8_t *)&snapshot + offsetof(RtcSnapshot, version);
+  return crc32Finish(crc32Update(kCrc32Init, begin, offsetof(RtcSnapshot, crc) - offsetof(RtcSnapshot, version)));
+}
+
+bool packStart(const String &startsAt, uint32_t &out) {
+  unsigned year = 0;
+  unsigned month = 0;
+  unsigned day = 0;
+  unsigned hour = 0;
+  unsigned minute = 0;
+  if (sscanf(startsAt.c_str(), "%4u-%2u-%2uT%2u:%2u", &year, &month, &day, &hour, &minute) != 5) return false;
+  if (year > 4095 || month > 12 || day > 31 || hour > 23 || minute > 59) return false;
+  out = (year << 20) | (month << 16) | (day << 11) | (hour << 6) | minute;
+  return true;
+}
+
+String unpackStart(uint32_t packed) {
+  char text[20];
+  snprintf(
+      text,
+      sizeof(text),
+      "%04u-%02u-%02uT%02u:%02u:00",
+      (unsigned)(packed >> 20),
+      (unsigned)((packed >> 16) & 0x0F),
+      (unsigned)((packed >> 11) & 0x1F),
+      (unsigned)((packed >> 6) & 0x1F),
+      (unsigned)(packed & 0x3F));
+  return String(text);
+}
+
+uint8_t levelIndex(const String &level) {
+  for (size_t i = 0; i < kLevelCount; ++i) {
+    if (level == kLevelNames[i]) return (uint8_t)i;
+  }
+  return 0;
+}
+
+void copyText(char *out, size_t outSize, const char *text) {
+  strncpy(out, text != nullptr ? text : "", outSize - 1);
+  out[outSize - 1] = '\0';
+}
+}  // namespace
+
+bool rtcStateSave(const PriceState &state, const char *timezoneSpec, time_t nextDailyFetch) {
+  if (!state.ok || state.count == 0 || state.count > kMaxPoints) return false;
+
+  // Invalidate first so a reset mid-save never restores a half-written snapshot.
+  RtcSnapshot &snapshot = gSnapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  for (size_t i = 0; i < state.count; ++i) {
+    const PricePoint &point = state.points[i];
+    if (!packStart(point.startsAt, snapshot.points[i].packedStart)) return false;
+    snapshot.points[i].price = point.price;
+    snapshot.points[i].rawPrice = point.rawPricePerKwh;
+    snapshot.levels[i] = levelIndex(point.level) | (point.hasRawPrice ? kRawPriceFlag : 0);
+  }
+
+  snapshot.version = kRtcStateVersion;
+  snapshot.count = (uint16_t)state.count;
+  snapshot.resolutionMinutes = state.resolutionMinutes;
+  snapshot.currentIndex = (int16_t)state.currentIndex;
+  snapshot.hasRunningAverage = state.hasRunningAverage ? 1 : 0;
+  snapshot.runningAverage = state.runningAverage;
+  snapshot.nextDailyFetch = (int64_t)nextDailyFetch;
+  copyText(snapshot.source, sizeof(snapshot.source), state.source.c_str());
+  copyText(snapshot.currency, sizeof(snapshot.currency), state.currency.c_str());
+  copyText(snapshot.timezone, sizeof(snapshot.timezone), timezoneSpec);
+  snapshot.crc = snapshotCrc(snapshot);
+  snapshot.magic = kRtcStateMagic;
+  return true;
+}
+
+bool rtcStateRestore(PriceState &out, char *timezoneSpec, size_t timezoneSpecSize, time_t &nextDailyFetch) {
+  if (gSnapshot.magic != kRtcStateMagic || gSnapshot.version != kRtcStateVersion) return false;
+  if (gSnapshot.count == 0 || gSnapshot.count > kMaxPoints) return false;
+  if (snapshotCrc(gSnapshot) != gSnapshot.crc) return false;
+
+  out = PriceState();
+  for (size_t i = 0; i < gSnapshot.count; ++i) {
+    PricePoint &point = out.points[i];
+    const uint8_t level = gSnapshot.levels[i] & (uint8_t)~kRawPriceFlag;
+    point.startsAt = unpackStart(gSnapshot.points[i].packedStart);
+    point.level = kLevelNames[level < kLevelCount ? level : 0];
+    point.price = gSnapshot.points[i].price;
+    point.rawPricePerKwh = gSnapshot.points[i].rawPrice;
+    point.hasRawPrice = (gSnapshot.levels[i] & kRawPriceFlag) != 0;
+  }
+  out.count = gSnapshot.count;
+  out.source = String(gSnapshot.source);
+  out.currency = String(gSnapshot.currency);
+  out.resolutionMinutes = gSnapshot.resolutionMinutes;
+  out.hasRunningAverage = gSnapshot.hasRunningAverage != 0;
+  out.runningAverage = gSnapshot.runningAverage;
+
+  int idx = gSnapshot.currentIndex;
+  if (idx < 0 || idx >= (int)out.count) idx = 0;
+  out.currentIndex = idx;
+  out.currentStartsAt = out.points[idx].startsAt;
+  out.currentLevel = out.points[idx].level;
+  out.currentPrice = out.points[idx].price;
+  out.ok = true;
+
+  copyText(timezoneSpec, timezoneSpecSize, gSnapshot.timezone);
+  nextDailyFetch = (time_t)gSnapshot.nextDailyFetch;
+  return true;
+}
+
+void rtcStateClear() {
+  gSnapshot.magic = 0;
+}
+
+uint8_t rtcStateNoteWarmBoot() {
+  // Power-on leaves RTC_NOINIT memory random; the magic tells.
+  if (gWarmBoots.magic != kWarmBootMagic) {
+    gWarmBoots.count = 0;
+    gWarmBoots.magic = kWarmBootMagic;
+  }
+  if (gWarmBoots.count < UINT8_MAX) ++gWarmBoots.count;
+  return (uint8_t)gWarmBoots.count;
+}
+
+void rtcStateMarkStable() {
+  gWarmBoots.magic = kWarmBootMagic;
+  gWarmBoots.count = 0;
+}
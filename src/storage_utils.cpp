@@ -0,0 +1,188 @@
+#include "storage_utils.h"
+
+#include <Arduino.h>
+#include <stdlib.h>
+
+#include "atomic_store.h"
+#include "logging_utils.h"
+#include "nordpool_ma_store.h"
+
+#ifndef CONFIG_STORAGE_LITTLEFS
+#define CONFIG_STORAGE_LITTLEFS 0
+#endif
+
+// Heap-backed RAM disk instead of flash; takes precedence over LittleFS.
+#ifndef CONFIG_STORAGE_RAMDISK
+#define CONFIG_STORAGE_RAMDISK 0
+#endif
+
+#if CONFIG_STORAGE_RAMDISK
+#include "ram_disk.h"
+#define STORAGE_BACKEND RamDisk
+#elif CONFIG_STORAGE_LITTLEFS
+#include <LittleFS.h>
+#define STORAGE_BACKEND LittleFS
+#else
+#include <SPIFFS.h>
+#define STORAGE_BACKEND SPIFFS
+#endif
+
+namespace {
+#if CONFIG_STORAGE_RAMDISK
+constexpr char kBackendName[] = "RAM";
+#elif CONFIG_STORAGE_LITTLEFS
+constexpr char kBackendName[] = "LittleFS";
+#else
+constexpr char kBackendName[] = "SPIFFS";
+#endif
+
+constexpr char kBenchPath[] = "/bench.bin";
+constexpr char kBenchRenamedPath[] = "/bench_mv.bin";
+constexpr char kBenchCommitPath[] = "/bench_ab.bin";
+constexpr uint8_t kBenchRuns = 5;
+// 192 points (two days at 15 min) serialize to roughly 18 KB of cache JSON.
+constexpr size_t kBenchCacheBytes = 18 * 1024;
+
+bool gMountAttempted = false;
+bool gMounted = false;
+
+struct BenchStats {
+  uint32_t totalUs = 0;
+  uint32_t maxUs = 0;
+  uint8_t runs = 0;
+
+  void add(uint32_t us) {
+    totalUs += us;
+    if (us > maxUs) maxUs = us;
+    ++runs;
+  }
+};
+
+void logBenchStats(const char *op, size_t bytes, const BenchStats &stats) {
+  if (stats.runs == 0) return;
+  logf(
+      "Storage bench %s: op=%s bytes=%u avg=%uus max=%uus",
+      kBackendName,
+      op,
+      (unsigned)bytes,
+      (unsigned)(stats.totalUs / stats.runs),
+      (unsigned)stats.maxUs);
+}
+
+void benchmarkFileSize(size_t bytes) {
+  uint8_t *buffer = (uint8_t *)malloc(bytes);
+  if (buffer == nullptr) {
+    logf("Storage bench skipped: no heap for %u bytes", (unsigned)bytes);
+    return;
+  }
+  for (size_t i = 0; i < bytes; ++i) {
+    buffer[i] = (uint8_t)(i * 31);
+  }
+
+  fs::FS &fs = storageFs();
+  const size_t usedBefore = STORAGE_BACKEND.usedBytes();
+#if CONFIG_STORAGE_RAMDISK
+  const size_t programmedBefore = RamDisk.bytesWritten();
+#endif
+  BenchStats openStats;
+  BenchStats writeStats;
+  BenchStats readStats;
+  BenchStats renameStats;
+  BenchStats removeStats;
+  BenchStats commitStats;
+
+  for (uint8_t run = 0; run < kBenchRuns; ++run) {
+    uint32_t start = micros();
+    File file = fs.open(kBenchPath, FILE_WRITE);
+    openStats.add(micros() - start);
+    if (!file) break;
+
+    start = micros();
+    const size_t written = file.write(buffer, bytes);
+    file.close();
+    writeStats.add(micros() - start);
+    if (written != bytes) break;
+
+    start = micros();
+    file = fs.open(kBenchPath, FILE_READ);
+    const size_t readBytes = file ? file.read(buffer, bytes) : 0;
+    file.close();
+    readStats.add(micros() - start);
+    if (readBytes != bytes) break;
+
+    start = micros();
+    const bool renamed = fs.rename(kBenchPath, kBenchRenamedPath);
+    renameStats.add(micros() - start);
+
+    start = micros();
+    fs.remove(renamed ? kBenchRenamedPath : kBenchPath);
+    removeStats.add(micros() - start);
+
+    start = micros();
+    atomicStoreWrite(fs, kBenchCommitPath, [buffer, bytes](Print &out) {
+      return out.write(buffer, bytes) == bytes;
+    });
+    commitStats.add(micros() - start);
+  }
+  const size_t usedPeak = STORAGE_BACKEND.usedBytes();
+#if CONFIG_STORAGE_RAMDISK
+  const size_t programmed = RamDisk.bytesWritten() - programmedBefore;
+#endif
+  atomicStoreRemove(fs, kBenchCommitPath);
+  free(buffer);
+
+  logBenchStats("open", bytes, openStats);
+  logBenchStats("write", bytes, writeStats);
+  logBenchStats("read", bytes, readStats);
+  logBenchStats("rename", bytes, renameStats);
+  logBenchStats("remove", bytes, removeStats);
+  logBenchStats("commit", bytes, commitStats);
+  // The flash backends expose no erase counters; block usage held by the A/B pair is the closest wear proxy.
+  logf(
+      "Storage bench %s: bytes=%u used_before=%u used_peak=%u",
+      kBackendName,
+      (unsigned)bytes,
+      (unsigned)usedBefore,
+      (unsigned)usedPeak);
+#if CONFIG_STORAGE_RAMDISK
+  // The RAM disk counts programmed bytes, which flash wear follows.
+  logf(
+      "Storage bench %s: bytes=%u programmed=%u per_run=%u",
+      kBackendName,
+      (unsigned)bytes,
+      (unsigned)programmed,
+      (unsigned)(programmed / kBenchRuns));
+#endif
+}
+}  // namespace
+
+bool storageMount() {
+  if (gMountAttempted) return gMounted;
+
+  gMountAttempted = true;
+  gMounted = STORAGE_BACKEND.begin(true);
+  logf("%s mount: %s", kBackendName, gMounted ? "ok" : "failed");
+  if (gMounted) {
+    logf(
+        "%s info: used=%u total=%u",
+        kBackendName,
+        (unsigned)STORAGE_BACKEND.usedBytes(),
+        (unsigned)STORAGE_BACKEND.totalBytes());
+  }
+  return gMounted;
+}
+
+fs::FS &storageFs() {
+  return STORAGE_BACKEND;
+}
+
+const char *storageBackendName() {
+  return kBackendName;
+}
+
+void storageRunBenchmark() {
+  if (!storageMount()) return;
+
+  benchmarkFileSize(sizeof(MovingAverageStore));
+  benchmarkFileSize(kBenchCacheBytes);
+}
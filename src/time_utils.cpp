@@ -1,6 +1,10 @@
 #include "time_utils.h"
 
+#include <atomic>
 #include <ctype.h>
+#include <esp_idf_version.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
 #include <string.h>
 
 #include "app_types.h"
@@ -10,6 +14,19 @@ namespace {
 constexpr char kTimezoneCetCest[] = "CET-1CEST,M3.5.0/2,M10.5.0/3";
 constexpr char kTimezoneEetEest[] = "EET-2EEST,M3.5.0/3,M10.5.0/4";
 
+// Written by the SNTP callback on the lwIP task, read by takeClockSync().
+std::atomic<bool> gClockSyncPending{false};
+int64_t gClockSyncNtpUs = 0;
+int64_t gClockSyncMonotonicUs = 0;
+ClockSyncListener gClockSyncListener = nullptr;
+
+void onSntpSync(struct timeval *tv) {
+  gClockSyncMonotonicUs = esp_timer_get_time();
+  gClockSyncNtpUs = ((int64_t)tv->tv_sec * 1000000LL) + tv->tv_usec;
+  gClockSyncPending.store(true, std::memory_order_release);
+  if (gClockSyncListener != nullptr) gClockSyncListener();
+}
+
 bool parseTwoDigits(const char *chars, int &out) {
   if (!isdigit((unsigned char)chars[0]) || !isdigit((unsigned char)chars[1])) {
     return false;
@@ -128,6 +145,20 @@ String utcIsoToLocalIsoSlot(const String &utcIso) {
   return String(out);
 }
 
+bool stateCoversLocalDay(const PriceState &state, time_t now, int dayOffset, time_t validEpochMin) {
+  if (!isValidClock(now, validEpochMin)) return false;
+
+  struct tm tmDay;
+  if (!localtime_r(&now, &tmDay)) return false;
+  tmDay.tm_mday += dayOffset;
+  tmDay.tm_hour = 12;  // midday keeps DST transitions from shifting the date
+  tmDay.tm_min = 0;
+  tmDay.tm_sec = 0;
+  const time_t day = mktime(&tmDay);
+  if (day == (time_t)-1) return false;
+  return stateContainsDate(state, dateKeyFromTime(day, validEpochMin));
+}
+
 const char *timezoneSpecForNordpoolArea(const String &area) {
   if (area == "FI" || area == "EE" || area == "LV" || area == "LT") {
     return kTimezoneEetEest;
@@ -231,14 +262,32 @@ bool shouldCatchUpMissedDailyUpdate(
   return !hasTomorrow;
 }
 
-void syncClock(const char *timezoneSpec) {
+void applyTimezone(const char *timezoneSpec) {
+  // The RTC keeps system time across software resets, but TZ lives in RAM.
+  setenv("TZ", timezoneSpec, 1);
+  tzset();
+}
+
+void startClockSync(const char *timezoneSpec, ClockSyncListener onSync) {
   logf("Clock sync start: tz=%s", timezoneSpec ? timezoneSpec : "(null)");
+  gClockSyncListener = onSync;
+  sntp_set_time_sync_notification_cb(onSntpSync);
+  // Restarts SNTP if it is still waiting on an earlier request.
   configTzTime(timezoneSpec, "pool.ntp.org", "time.nist.gov");
-  for (int i = 0; i < 20; ++i) {
-    if (time(nullptr) > 1700000000) break;
-    delay(250);
-  }
-  logf("Clock sync status: now=%ld", (long)time(nullptr));
+}
+
+bool takeClockSync(ClockSyncSample &out) {
+  if (!gClockSyncPending.load(std::memory_order_acquire)) return false;
+  out.ntpUs = gClockSyncNtpUs;
+  out.monotonicUs = gClockSyncMonotonicUs;
+  gClockSyncPending.store(false, std::memory_order_release);
+  // Left running, SNTP would poll on its own schedule; the caller picks the next resync.
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_sntp_stop();
+#else
+  sntp_stop();
+#endif
+  return true;
 }
 
 time_t scheduleNextDailyFetch(time_t now, int hour, int minute) {
@@ -0,0 +1,90 @@
+#include "timer_queue.h"
+
+namespace {
+bool before(uint32_t a, uint32_t b) {
+  return (int32_t)(a - b) < 0;
+}
+
+void swapEntries(TimerQueue::Entry &a, TimerQueue::Entry &b) {
+  const TimerQueue::Entry tmp = a;
+  a = b;
+  b = tmp;
+}
+
+void siftUp(TimerQueue &queue, size_t index) {
+  while (index > 0) {
+    const size_t parent = (index - 1) / 2;
+    if (!before(queue.entries[index].dueMs, queue.entries[parent].dueMs)) break;
+    swapEntries(queue.entries[index], queue.entries[parent]);
+    index = parent;
+  }
+}
+
+void siftDown(TimerQueue &queue, size_t index) {
+  for (;;) {
+    const size_t left = (2 * index) + 1;
+    const size_t right = left + 1;
+    size_t smallest = index;
+    if (left < queue.size && before(queue.entries[left].dueMs, queue.entries[smallest].dueMs)) smallest = left;
+    if (right < queue.size && before(queue.entries[right].dueMs, queue.entries[smallest].dueMs)) smallest = right;
+    if (smallest == index) break;
+    swapEntries(queue.entries[index], queue.entries[smallest]);
+    index = smallest;
+  }
+}
+
+int findIndex(const TimerQueue &queue, uint8_t id) {
+  for (size_t i = 0; i < queue.size; ++i) {
+    if (queue.entries[i].id == id) return (int)i;
+  }
+  return -1;
+}
+
+void removeAt(TimerQueue &queue, size_t index) {
+  --queue.size;
+  if (index == queue.size) return;
+  queue.entries[index] = queue.entries[queue.size];
+  siftUp(queue, index);
+  siftDown(queue, index);
+}
+}  // namespace
+
+bool TimerQueue::schedule(uint8_t id, uint32_t dueMs) {
+  const int existing = findIndex(*this, id);
+  if (existing >= 0) {
+    entries[existing].dueMs = dueMs;
+    siftUp(*this, (size_t)existing);
+    siftDown(*this, (size_t)existing);
+    return true;
+  }
+  if (size >= kMaxTimers) return false;
+
+  entries[size].id = id;
+  entries[size].dueMs = dueMs;
+  ++size;
+  siftUp(*this, size - 1);
+  return true;
+}
+
+void TimerQueue::cancel(uint8_t id) {
+  const int index = findIndex(*this, id);
+  if (index >= 0) removeAt(*this, (size_t)index);
+}
+
+bool TimerQueue::scheduled(uint8_t id) const {
+  return findIndex(*this, id) >= 0;
+}
+
+uint32_t TimerQueue::waitMs(uint32_t nowMs, uint32_t maxWaitMs) const {
+  if (size == 0) return maxWaitMs;
+  if (!before(nowMs, entries[0].dueMs)) return 0;
+  const uint32_t wait = entries[0].dueMs - nowMs;
+  return wait < maxWaitMs ? wait : maxWaitMs;
+}
+
+bool TimerQueue::popDue(uint32_t nowMs, uint8_t &id) {
+  if (size == 0 || before(nowMs, entries[0].dueMs)) return false;
+  id = entries[0].id;
+  removeAt(*this, 0);
+  return true;
+}
@@ -2,16 +2,42 @@
 #include <Preferences.h>
 #include <WiFi.h>
 #include <WiFiManager.h>
+#include <algorithm>
+#include <atomic>
 #include <ctype.h>
+#include <esp_wifi.h>
 #include <inttypes.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "display_ui.h"
 #include "logging_utils.h"
 #include "time_utils.h"
 #include "wifi_utils.h"
 
+// Optional fixed addressing, e.g. -D CONFIG_WIFI_STATIC_IP=\"192.168.1.50\".
+#ifndef CONFIG_WIFI_STATIC_IP
+#define CONFIG_WIFI_STATIC_IP ""
+#endif
+
+#ifndef CONFIG_WIFI_STATIC_GATEWAY
+#define CONFIG_WIFI_STATIC_GATEWAY ""
+#endif
+
+#ifndef CONFIG_WIFI_STATIC_SUBNET
+#define CONFIG_WIFI_STATIC_SUBNET "255.255.255.0"
+#endif
+
+#ifndef CONFIG_WIFI_STATIC_DNS
+#define CONFIG_WIFI_STATIC_DNS ""
+#endif
+
+// Reuses the last DHCP lease on a fast connect instead of asking again.
+#ifndef CONFIG_WIFI_REUSE_LEASE
+#define CONFIG_WIFI_REUSE_LEASE 0
+#endif
+
 namespace
 {
   constexpr char kPrefsNamespace[] = "elcfg";
@@ -41,10 +67,50 @@ namespace
   constexpr size_t kResolutionMaxLen = 4;
   constexpr size_t kVatPercentMaxLen = 16;
   constexpr size_t kFixedCostPerKwhMaxLen = 16;
-  constexpr uint32_t kReconnectCooldownMs = 5000;
-
+  constexpr uint32_t kReconnectCooldownMs = 5000;     // first backoff after a failed attempt
+  constexpr uint32_t kReconnectBackoffMaxMs = 60000;
+  constexpr char kLinkCacheKey[] = "wl_link";
+  // Long enough for auth + DHCP on a known channel, short enough that a moved AP costs little.
+  constexpr uint32_t kFastConnectTimeoutMs = 2000;
+  // The portal's web and DNS servers are polled, not interrupt driven.
+  constexpr uint32_t kPortalPollMs = 20;
+  // process() waits this long for credentials saved in the portal. It runs
+  // on its own task, so only the portal pages stall meanwhile.
+  constexpr uint16_t kPortalConnectTimeoutSeconds = 15;
+  constexpr uint32_t kPortalTaskStackBytes = 8192;
+  constexpr BaseType_t kPortalTaskCore = 0; // next to the WiFi stack
+  constexpr UBaseType_t kPortalTaskPriority = 1;
+
+  // Guards the submitted form and gSaveConfigRequested between the portal
+  // task and the caller of wifiPortalService().
+  portMUX_TYPE gPortalLock = portMUX_INITIALIZER_UNLOCKED;
   bool gSaveConfigRequested = false;
-  uint32_t gLastReconnectAttemptMs = 0;
+
+  // Last AP and lease that worked, for a directed connect without a scan.
+  struct WifiLinkCache
+  {
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+  };
+
+  // Phase timestamps of the current attempt, written from the WiFi event task.
+  volatile uint32_t gAssociatedMs = 0;
+  volatile uint32_t gGotIpMs = 0;
+  bool gLinkEventsRegistered = false;
+  WifiLinkListener gLinkListener = nullptr;
+
+  // Owned by the task calling wifiLinkService().
+  WifiLinkState gLinkState = WifiLinkState::Idle;
+  bool gLinkAttemptFast = false;
+  uint32_t gLinkAttemptStartMs = 0;
+  uint32_t gLinkDueMs = 0; // attempt deadline or end of backoff
+  uint32_t gLinkBackoffMs = kReconnectCooldownMs;
+  uint32_t gLinkConnectTimeoutMs = 20000;
+  bool gLinkCredentialsMissing = false;
 
   constexpr char kPortalCustomHead[] PROGMEM = R"HTML(
 <script>
@@ -189,17 +255,125 @@ namespace
     secrets.fixedCostPerKwh = normalizeFixedCostPerKwh(secrets.fixedCostPerKwh);
   }
 
+  // Form defaults for the portal, formatted from the current settings.
+  struct PortalFields
+  {
+    explicit PortalFields(const AppSecrets &secrets)
+    {
+      secrets.nordpoolApiUrl.toCharArray(apiUrl, sizeof(apiUrl));
+      secrets.nordpoolArea.toCharArray(area, sizeof(area));
+      secrets.nordpoolCurrency.toCharArray(currency, sizeof(currency));
+      snprintf(resolution, sizeof(resolution), "%u", (unsigned)secrets.nordpoolResolutionMinutes);
+      snprintf(vatPercent, sizeof(vatPercent), "%.2f", secrets.vatPercent);
+      snprintf(fixedCostPerKwh, sizeof(fixedCostPerKwh), "%.4f", secrets.fixedCostPerKwh);
+    }
+
+    char apiUrl[kApiUrlMaxLen + 1];
+    char area[kAreaMaxLen + 1];
+    char currency[kCurrencyMaxLen + 1];
+    char resolution[kResolutionMaxLen + 1];
+    char vatPercent[kVatPercentMaxLen + 1];
+    char fixedCostPerKwh[kFixedCostPerKwhMaxLen + 1];
+  };
+
+  // Lives while the portal is open; WiFiManager keeps pointers to the parameters.
+  struct PortalSession
+  {
+    explicit PortalSession(const PortalFields &fields)
+        : apiUrlParam("NordPoolApiUrl", "Nord Pool API URL:", fields.apiUrl, sizeof(fields.apiUrl)),
+          areaParam("NordPoolArea", "Nord Pool area:", fields.area, sizeof(fields.area)),
+          currencyParam("NordPoolCurrency", "currency:", fields.currency, sizeof(fields.currency)),
+          resolutionParam("NordPoolResolution", "Resolution (minutes):", fields.resolution, sizeof(fields.resolution)),
+          vatPercentParam("VatPercent", "VAT (%):", fields.vatPercent, sizeof(fields.vatPercent)),
+          fixedCostPerKwhParam(
+              "FixedCostPerKwh",
+              "Total fixed cost / kWh (cents):",
+              fields.fixedCostPerKwh,
+              sizeof(fields.fixedCostPerKwh)),
+          submitted(fields)
+    {
+    }
+
+    WiFiManager manager;
+    WiFiManagerParameter apiUrlParam;
+    WiFiManagerParameter areaParam;
+    WiFiManagerParameter currencyParam;
+    WiFiManagerParameter resolutionParam;
+    WiFiManagerParameter vatPercentParam;
+    WiFiManagerParameter fixedCostPerKwhParam;
+    // Copy of the parameters taken on the portal task when a form is saved.
+    PortalFields submitted;
+  };
+
+  PortalSession *gPortal = nullptr;
+  // Runs gPortal's process(); null when it could not start and the caller
+  // of wifiPortalService() polls instead.
+  TaskHandle_t gPortalTask = nullptr;
+  std::atomic<bool> gPortalTaskDone{false};
+  uint16_t gPortalTimeoutSeconds = 0;
+  // The boot scan with stored credentials opens the portal if it fails.
+  bool gPortalAfterBootScan = false;
+  // Opened by the link state machine; reported once by wifiPortalService().
+  bool gPortalOpenedLate = false;
+
+  void logConnectedSettings(const AppSecrets &secrets)
+  {
+    logf("WiFi connected: ssid='%s' ip=%s area=%s currency=%s resolution=%u vat=%.2f%% fixed_minor_kwh=%.2f",
+         WiFi.SSID().c_str(),
+         WiFi.localIP().toString().c_str(),
+         secrets.nordpoolArea.c_str(),
+         secrets.nordpoolCurrency.c_str(),
+         (unsigned)secrets.nordpoolResolutionMinutes,
+         secrets.vatPercent,
+         secrets.fixedCostPerKwh);
+  }
+
+  void copyParam(char *out, size_t size, WiFiManagerParameter &param)
+  {
+    strlcpy(out, param.getValue() != nullptr ? param.getValue() : "", size);
+  }
+
+  // Runs inside process(), on the portal task when it is up.
   void saveConfigCallback()
   {
+    PortalFields &form = gPortal->submitted;
+    portENTER_CRITICAL(&gPortalLock);
+    copyParam(form.apiUrl, sizeof(form.apiUrl), gPortal->apiUrlParam);
+    copyParam(form.area, sizeof(form.area), gPortal->areaParam);
+    copyParam(form.currency, sizeof(form.currency), gPortal->currencyParam);
+    copyParam(form.resolution, sizeof(form.resolution), gPortal->resolutionParam);
+    copyParam(form.vatPercent, sizeof(form.vatPercent), gPortal->vatPercentParam);
+    copyParam(form.fixedCostPerKwh, sizeof(form.fixedCostPerKwh), gPortal->fixedCostPerKwhParam);
     gSaveConfigRequested = true;
+    portEXIT_CRITICAL(&gPortalLock);
+    if (gLinkListener != nullptr)
+      gLinkListener();
+  }
+
+  // Keeps the blocking connect WiFiManager runs after a save off the caller's
+  // task; the clock, slot changes and the button carry on meanwhile.
+  void portalTask(void *)
+  {
+    WiFiManager &manager = gPortal->manager;
+    while (manager.getConfigPortalActive())
+    {
+      manager.process();
+      vTaskDelay(pdMS_TO_TICKS(kPortalPollMs));
+    }
+    // gPortal may be deleted from here on.
+    gPortalTaskDone = true;
+    if (gLinkListener != nullptr)
+      gLinkListener();
+    vTaskDelete(nullptr);
   }
 
   bool waitForConnection(uint32_t timeoutMs)
   {
     const uint32_t start = millis();
+    // Fine-grained so a directed connect is not rounded up to the poll period.
     while (WiFi.status() != WL_CONNECTED && millis() - start < timeoutMs)
     {
-      delay(250);
+      delay(20);
     }
     return WiFi.status() == WL_CONNECTED;
   }
@@ -228,6 +402,295 @@ namespace
         secrets.fixedCostPerKwh);
   }
 
+  void onLinkEvent(WiFiEvent_t event)
+  {
+    if (event == ARDUINO_EVENT_WIFI_STA_CONNECTED)
+      gAssociatedMs = millis();
+    else if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+      gGotIpMs = millis();
+    else if (event != ARDUINO_EVENT_WIFI_STA_DISCONNECTED && event != ARDUINO_EVENT_WIFI_STA_LOST_IP)
+      return;
+    if (gLinkListener != nullptr)
+      gLinkListener();
+  }
+
+  bool loadLinkCache(WifiLinkCache &out)
+  {
+    Preferences prefs;
+    if (!prefs.begin(kPrefsNamespace, true))
+      return false;
+    const bool ok = prefs.getBytesLength(kLinkCacheKey) == sizeof(out) &&
+                    prefs.getBytes(kLinkCacheKey, &out, sizeof(out)) == sizeof(out);
+    prefs.end();
+    return ok && out.channel != 0;
+  }
+
+  void saveLinkCache()
+  {
+    WifiLinkCache link = {};
+    const uint8_t *bssid = WiFi.BSSID();
+    if (bssid == nullptr)
+      return;
+    memcpy(link.bssid, bssid, sizeof(link.bssid));
+    link.channel = (uint8_t)WiFi.channel();
+    link.ip = (uint32_t)WiFi.localIP();
+    link.gateway = (uint32_t)WiFi.gatewayIP();
+    link.subnet = (uint32_t)WiFi.subnetMask();
+    link.dns = (uint32_t)WiFi.dnsIP();
+
+    WifiLinkCache stored;
+    if (loadLinkCache(stored) && memcmp(&stored, &link, sizeof(link)) == 0)
+      return;
+    Preferences prefs;
+    if (!prefs.begin(kPrefsNamespace, false))
+      return;
+    prefs.putBytes(kLinkCacheKey, &link, sizeof(link));
+    prefs.end();
+    logf(
+        "WiFi link cached: bssid=%02x:%02x:%02x:%02x:%02x:%02x channel=%u ip=%s",
+        link.bssid[0], link.bssid[1], link.bssid[2], link.bssid[3], link.bssid[4], link.bssid[5],
+        (unsigned)link.channel,
+        WiFi.localIP().toString().c_str());
+  }
+
+  // Credentials WiFiManager left in the driver's NVS config.
+  bool loadStationCredentials(char *ssid, size_t ssidSize, char *password, size_t passwordSize)
+  {
+    wifi_config_t config = {};
+    if (esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK || config.sta.ssid[0] == '\0')
+      return false;
+    snprintf(ssid, ssidSize, "%.*s", (int)sizeof(config.sta.ssid), (const char *)config.sta.ssid);
+    snprintf(password, passwordSize, "%.*s", (int)sizeof(config.sta.password), (const char *)config.sta.password);
+    return true;
+  }
+
+  // Static addressing from the build, else the cached lease when reuse is
+  // enabled, else DHCP.
+  void applyAddressing(const WifiLinkCache *lease)
+  {
+    IPAddress ip;
+    IPAddress gateway;
+    IPAddress subnet;
+    IPAddress dns;
+    if (ip.fromString(CONFIG_WIFI_STATIC_IP) && gateway.fromString(CONFIG_WIFI_STATIC_GATEWAY) &&
+        subnet.fromString(CONFIG_WIFI_STATIC_SUBNET))
+    {
+      if (!dns.fromString(CONFIG_WIFI_STATIC_DNS))
+        dns = gateway;
+      WiFi.config(ip, gateway, subnet, dns);
+    }
+    else if (CONFIG_WIFI_REUSE_LEASE && lease != nullptr && lease->ip != 0)
+    {
+      WiFi.config(IPAddress(lease->ip), IPAddress(lease->gateway), IPAddress(lease->subnet), IPAddress(lease->dns));
+    }
+    else
+    {
+      WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    }
+  }
+
+  // Starts a connect without waiting: directed at the cached AP when `link`
+  // is set, else a full scan. False when there is nothing to connect to.
+  bool beginAttempt(const WifiLinkCache *link)
+  {
+    char ssid[33];
+    char password[65];
+    if (!loadStationCredentials(ssid, sizeof(ssid), password, sizeof(password)))
+    {
+      logf("WiFi connect skipped: no stored credentials");
+      return false;
+    }
+    if (!gLinkEventsRegistered)
+    {
+      WiFi.onEvent(onLinkEvent);
+      gLinkEventsRegistered = true;
+    }
+
+    // The credentials are already in NVS; retries must not rewrite the
+    // driver config in flash on every backoff cycle of an outage.
+    WiFi.persistent(false);
+    applyAddressing(link);
+    gAssociatedMs = 0;
+    gGotIpMs = 0;
+    gLinkAttemptFast = link != nullptr;
+    gLinkAttemptStartMs = millis();
+    if (link != nullptr)
+      WiFi.begin(ssid, password, link->channel, link->bssid, true);
+    else
+      WiFi.begin(ssid, password);
+    return true;
+  }
+
+  // Logs how long association and addressing took in the current attempt.
+  void logAttempt(bool connected)
+  {
+    const uint32_t associatedMs = gAssociatedMs;
+    const uint32_t gotIpMs = gGotIpMs;
+    logf(
+        "WiFi connect attempt: mode=%s result=%s assoc=%ldms ip=%ldms total=%lums",
+        gLinkAttemptFast ? "fast" : "scan",
+        connected ? "ok" : "fail",
+        associatedMs != 0 ? (long)(associatedMs - gLinkAttemptStartMs) : -1L,
+        gotIpMs != 0 ? (long)(gotIpMs - gLinkAttemptStartMs) : -1L,
+        (unsigned long)(millis() - gLinkAttemptStartMs));
+  }
+
+  // Blocking directed connect, used at boot before anything else runs.
+  bool connectAttempt(const WifiLinkCache *link, uint32_t timeoutMs)
+  {
+    if (!beginAttempt(link))
+      return false;
+    const bool connected = waitForConnection(timeoutMs);
+    logAttempt(connected);
+    return connected;
+  }
+
+  void setLinkState(WifiLinkState state, uint32_t dueMs)
+  {
+    if (state != gLinkState)
+      logf("WiFi link: %s -> %s", wifiLinkStateName(gLinkState), wifiLinkStateName(state));
+    gLinkState = state;
+    gLinkDueMs = dueMs;
+    if (state == WifiLinkState::Connected)
+    {
+      gLinkCredentialsMissing = false;
+      gPortalAfterBootScan = false;
+    }
+  }
+
+  // Every way into Connected goes through here, so the cache always holds
+  // the AP and lease last used.
+  void enterLinkConnected(uint32_t nowMs)
+  {
+    saveLinkCache();
+    gLinkBackoffMs = kReconnectCooldownMs;
+    setLinkState(WifiLinkState::Connected, nowMs);
+    logf("WiFi connected: ip=%s rssi=%d", WiFi.localIP().toString().c_str(), WiFi.RSSI());
+  }
+
+  // Directed connect when a link is cached, else a full scan.
+  void startLinkAttempt(uint32_t nowMs)
+  {
+    WifiLinkCache link;
+    const bool haveLink = loadLinkCache(link);
+    if (!beginAttempt(haveLink ? &link : nullptr))
+    {
+      // Only the portal can fix this; stay idle without a deadline.
+      gLinkCredentialsMissing = true;
+      setLinkState(WifiLinkState::Idle, nowMs);
+      return;
+    }
+    setLinkState(WifiLinkState::Connecting, nowMs + (haveLink ? kFastConnectTimeoutMs : gLinkConnectTimeoutMs));
+  }
+
+  // Opens the WiFiManager portal in AP+STA mode and returns at once;
+  // wifiPortalService() runs it from then on.
+  void startPortal(const AppSecrets &secrets, uint16_t timeoutSeconds, bool drawInstructions)
+  {
+    gPortal = new PortalSession(PortalFields(secrets));
+    gPortalTimeoutSeconds = timeoutSeconds;
+    WiFiManager &manager = gPortal->manager;
+    gSaveConfigRequested = false;
+    manager.addParameter(&gPortal->apiUrlParam);
+    manager.addParameter(&gPortal->areaParam);
+    manager.addParameter(&gPortal->currencyParam);
+    manager.addParameter(&gPortal->resolutionParam);
+    manager.addParameter(&gPortal->vatPercentParam);
+    manager.addParameter(&gPortal->fixedCostPerKwhParam);
+    manager.setConfigPortalBlocking(false);
+    manager.setConfigPortalTimeout(timeoutSeconds);
+    manager.setConnectTimeout(kPortalConnectTimeoutSeconds);
+    manager.setSaveConnectTimeout(kPortalConnectTimeoutSeconds);
+    manager.setConnectRetries(1);
+    manager.setSaveConfigCallback(saveConfigCallback);
+    // The settings page saves without touching Wi-Fi.
+    manager.setSaveParamsCallback(saveConfigCallback);
+    const char *menu[] = {"wifi", "param", "info", "exit"};
+    manager.setMenu(menu, sizeof(menu) / sizeof(menu[0]));
+    manager.setCustomHeadElement(kPortalCustomHead);
+    manager.setDarkMode(true);
+
+    char apName[32];
+    wifiPortalApName(apName, sizeof(apName));
+    if (drawInstructions)
+      displayDrawWifiConfigPortal(apName, timeoutSeconds);
+
+    logf("Config portal start: AP='%s' timeout=%us", apName, (unsigned)timeoutSeconds);
+    WiFi.mode(WIFI_AP_STA);
+    manager.startConfigPortal(apName);
+
+    gPortalTaskDone = false;
+    if (xTaskCreatePinnedToCore(
+            portalTask, "portal", kPortalTaskStackBytes, nullptr, kPortalTaskPriority, &gPortalTask, kPortalTaskCore) !=
+        pdPASS)
+    {
+      gPortalTask = nullptr;
+      logf("Config portal task start failed, polling from the caller");
+    }
+  }
+
+  void failLinkAttempt(uint32_t nowMs)
+  {
+    logAttempt(false);
+    if (gPortalAfterBootScan)
+    {
+      // The stored network did not answer at boot; ask for another one.
+      gPortalAfterBootScan = false;
+      WiFi.disconnect(false);
+      AppSecrets secrets;
+      loadAppSecrets(secrets);
+      applyAddressing(nullptr);
+      startPortal(secrets, gPortalTimeoutSeconds, false);
+      gPortalOpenedLate = true;
+      setLinkState(WifiLinkState::Idle, nowMs);
+      // Reported by the next wifiPortalService() call.
+      if (gLinkListener != nullptr)
+        gLinkListener();
+      return;
+    }
+    if (gLinkAttemptFast && gPortal == nullptr)
+    {
+      // The directed attempt leaves the driver pinned to the old AP.
+      WiFi.disconnect(false);
+      if (beginAttempt(nullptr))
+      {
+        setLinkState(WifiLinkState::Connecting, nowMs + gLinkConnectTimeoutMs);
+        return;
+      }
+    }
+    WiFi.disconnect(false);
+    logf("WiFi reconnect failed: status=%d retry in %lums", WiFi.status(), (unsigned long)gLinkBackoffMs);
+    setLinkState(WifiLinkState::Backoff, nowMs + gLinkBackoffMs);
+    gLinkBackoffMs = std::min(gLinkBackoffMs * 2, kReconnectBackoffMaxMs);
+  }
+
+  // Saves what the portal form submitted and reports which kind of setting changed.
+  uint8_t applyPortalFields(const PortalFields &form, AppSecrets &secrets)
+  {
+    AppSecrets updated = secrets;
+    updated.nordpoolApiUrl = String(form.apiUrl);
+    updated.nordpoolArea = String(form.area);
+    updated.nordpoolCurrency = String(form.currency);
+    updated.nordpoolResolutionMinutes = parseResolutionToken(String(form.resolution));
+    updated.vatPercent = parseFloatToken(String(form.vatPercent), secrets.vatPercent);
+    updated.fixedCostPerKwh = parseFloatToken(String(form.fixedCostPerKwh), secrets.fixedCostPerKwh);
+    normalizeSecrets(updated);
+
+    uint8_t changes = 0;
+    if (updated.nordpoolApiUrl != secrets.nordpoolApiUrl || updated.nordpoolArea != secrets.nordpoolArea ||
+        updated.nordpoolCurrency != secrets.nordpoolCurrency ||
+        updated.nordpoolResolutionMinutes != secrets.nordpoolResolutionMinutes)
+      changes |= kPortalSourceSettingsChanged;
+    if (updated.vatPercent != secrets.vatPercent || updated.fixedCostPerKwh != secrets.fixedCostPerKwh)
+      changes |= kPortalFormulaSettingsChanged;
+    if (changes == 0)
+      return 0;
+
+    secrets = updated;
+    saveSecretsToPrefs(secrets);
+    return changes;
+  }
+
 } // namespace
 
 void loadAppSecrets(AppSecrets &out)
@@ -271,7 +734,7 @@ void loadAppSecrets(AppSecrets &out)
   normalizeSecrets(out);
 }
 
-bool wifiConnectWithConfigPortal(AppSecrets &secrets, uint16_t portalTimeoutSeconds)
+bool wifiConnectWithConfigPortal(AppSecrets &secrets, uint16_t portalTimeoutSeconds, bool drawPortalScreen)
 {
   loadAppSecrets(secrets);
   if (WiFi.status() == WL_CONNECTED)
@@ -281,121 +744,207 @@ bool wifiConnectWithConfigPortal(AppSecrets &secrets, uint16_t portalTimeoutSeco
 
   WiFi.mode(WIFI_STA);
 
-  char apiUrlBuffer[kApiUrlMaxLen + 1];
-  char areaBuffer[kAreaMaxLen + 1];
-  char currencyBuffer[kCurrencyMaxLen + 1];
-  char resolutionBuffer[kResolutionMaxLen + 1];
-  char vatPercentBuffer[kVatPercentMaxLen + 1];
-  char fixedCostPerKwhBuffer[kFixedCostPerKwhMaxLen + 1];
-  secrets.nordpoolApiUrl.toCharArray(apiUrlBuffer, sizeof(apiUrlBuffer));
-  secrets.nordpoolArea.toCharArray(areaBuffer, sizeof(areaBuffer));
-  secrets.nordpoolCurrency.toCharArray(currencyBuffer, sizeof(currencyBuffer));
-  snprintf(resolutionBuffer, sizeof(resolutionBuffer), "%u", (unsigned)secrets.nordpoolResolutionMinutes);
-  snprintf(vatPercentBuffer, sizeof(vatPercentBuffer), "%.2f", secrets.vatPercent);
-  snprintf(fixedCostPerKwhBuffer, sizeof(fixedCostPerKwhBuffer), "%.4f", secrets.fixedCostPerKwh);
-
-  WiFiManager wifiManager;
-  WiFiManagerParameter apiUrlParam("NordPoolApiUrl", "Nord Pool API URL:", apiUrlBuffer, sizeof(apiUrlBuffer));
-  WiFiManagerParameter areaParam("NordPoolArea", "Nord Pool area:", areaBuffer, sizeof(areaBuffer));
-  WiFiManagerParameter currencyParam("NordPoolCurrency", "currency:", currencyBuffer, sizeof(currencyBuffer));
-  WiFiManagerParameter resolutionParam(
-      "NordPoolResolution",
-      "Resolution (minutes):",
-      resolutionBuffer,
-      sizeof(resolutionBuffer));
-  WiFiManagerParameter vatPercentParam(
-      "VatPercent",
-      "VAT (%):",
-      vatPercentBuffer,
-      sizeof(vatPercentBuffer));
-  WiFiManagerParameter fixedCostPerKwhParam(
-      "FixedCostPerKwh",
-      "Total fixed cost / kWh (cents):",
-      fixedCostPerKwhBuffer,
-      sizeof(fixedCostPerKwhBuffer));
+  // A known AP needs neither WiFiManager's scan nor its portal.
+  WifiLinkCache link;
+  if (loadLinkCache(link))
+  {
+    if (connectAttempt(&link, kFastConnectTimeoutMs))
+    {
+      logConnectedSettings(secrets);
+      return true;
+    }
+    WiFi.disconnect(false);
+  }
 
-  gSaveConfigRequested = false;
-  wifiManager.addParameter(&apiUrlParam);
-  wifiManager.addParameter(&areaParam);
-  wifiManager.addParameter(&currencyParam);
-  wifiManager.addParameter(&resolutionParam);
-  wifiManager.addParameter(&vatPercentParam);
-  wifiManager.addParameter(&fixedCostPerKwhParam);
-  wifiManager.setConfigPortalTimeout(portalTimeoutSeconds);
-  wifiManager.setSaveConfigCallback(saveConfigCallback);
-  wifiManager.setCustomHeadElement(kPortalCustomHead);
-  wifiManager.setDarkMode(true);
-
-  char apName[32];
-  snprintf(apName, sizeof(apName), "ElMeter-%" PRIx64, ESP.getEfuseMac());
-  const String apNameString(apName);
-
-  wifiManager.setAPCallback([apNameString, portalTimeoutSeconds](WiFiManager *)
-                            { displayDrawWifiConfigPortal(apNameString.c_str(), portalTimeoutSeconds); });
-  wifiManager.setConfigPortalTimeoutCallback([portalTimeoutSeconds]()
-                                             { displayDrawWifiConfigTimeout(portalTimeoutSeconds); });
-
-  logf("WiFiManager autoConnect start: AP='%s' timeout=%us", apName, (unsigned)portalTimeoutSeconds);
-  if (!wifiManager.autoConnect(apName))
-  {
-    logf("WiFiManager failed or timed out");
+  // Stored credentials get a full scan before anyone is asked for new ones.
+  // It runs in the link state machine, so boot goes on while it scans.
+  gPortalTimeoutSeconds = portalTimeoutSeconds;
+  if (beginAttempt(nullptr))
+  {
+    gPortalAfterBootScan = true;
+    setLinkState(WifiLinkState::Connecting, millis() + gLinkConnectTimeoutMs);
     return false;
   }
+  applyAddressing(nullptr);
+
+  // Link attempts are suspended while the portal is open; it connects itself
+  // when credentials are saved.
+  startPortal(secrets, portalTimeoutSeconds, drawPortalScreen);
+  return false;
+}
+
+uint8_t wifiPortalService(AppSecrets &secrets)
+{
+  if (gPortal == nullptr)
+    return 0;
 
-  if (gSaveConfigRequested)
+  if (gPortalTask == nullptr)
+    gPortal->manager.process();
+  uint8_t changes = 0;
+  if (gPortalOpenedLate)
   {
-    secrets.nordpoolApiUrl = String(apiUrlParam.getValue());
-    secrets.nordpoolArea = String(areaParam.getValue());
-    secrets.nordpoolCurrency = String(currencyParam.getValue());
-    secrets.nordpoolResolutionMinutes = parseResolutionToken(String(resolutionParam.getValue()));
-    secrets.vatPercent = parseFloatToken(String(vatPercentParam.getValue()), secrets.vatPercent);
-    secrets.fixedCostPerKwh = parseFloatToken(String(fixedCostPerKwhParam.getValue()), secrets.fixedCostPerKwh);
-    normalizeSecrets(secrets);
-    saveSecretsToPrefs(secrets);
-    gSaveConfigRequested = false;
+    gPortalOpenedLate = false;
+    changes |= kPortalOpened;
   }
-  else
+
+  // Read before the form, so a save made just before closing is not lost.
+  const bool closed = gPortalTask != nullptr ? gPortalTaskDone.load() : !gPortal->manager.getConfigPortalActive();
+  portENTER_CRITICAL(&gPortalLock);
+  const bool saved = gSaveConfigRequested;
+  gSaveConfigRequested = false;
+  const PortalFields form = gPortal->submitted;
+  portEXIT_CRITICAL(&gPortalLock);
+  if (saved)
+    changes |= applyPortalFields(form, secrets);
+  if (closed)
   {
-    normalizeSecrets(secrets);
+    const bool connected = WiFi.status() == WL_CONNECTED;
+    logf("Config portal closed: wifi=%s", connected ? "connected" : "down");
+    delete gPortal;
+    gPortal = nullptr;
+    gPortalTask = nullptr;
+    char ssid[33];
+    char password[65];
+    if (!connected && !loadStationCredentials(ssid, sizeof(ssid), password, sizeof(password)))
+    {
+      // Nothing to retry without credentials; the setup screen stays valid.
+      logf("Config portal reopened: no stored credentials");
+      startPortal(secrets, gPortalTimeoutSeconds, false);
+      return changes;
+    }
+    if (WiFi.getMode() == WIFI_AP_STA)
+      WiFi.mode(WIFI_STA);
+    changes |= kPortalClosed;
+    // Resume link attempts right away; credentials may have been saved.
+    gLinkCredentialsMissing = false;
+    if (gLinkState != WifiLinkState::Connected)
+      gLinkDueMs = millis();
   }
+  return changes;
+}
 
-  logf("WiFi connected: ssid='%s' ip=%s area=%s currency=%s resolution=%u vat=%.2f%% fixed_minor_kwh=%.2f",
-       WiFi.SSID().c_str(),
-       WiFi.localIP().toString().c_str(),
-       secrets.nordpoolArea.c_str(),
-       secrets.nordpoolCurrency.c_str(),
-       (unsigned)secrets.nordpoolResolutionMinutes,
-       secrets.vatPercent,
-       secrets.fixedCostPerKwh);
-  return true;
+bool wifiPortalActive()
+{
+  return gPortal != nullptr;
 }
 
-bool wifiReconnect(uint32_t timeoutMs)
+void wifiPortalApName(char *out, size_t size)
 {
-  if (WiFi.status() == WL_CONNECTED)
+  snprintf(out, size, "ElMeter-%" PRIx64, ESP.getEfuseMac());
+}
+
+const char *wifiLinkStateName(WifiLinkState state)
+{
+  switch (state)
   {
-    return true;
+  case WifiLinkState::Idle:
+    return "idle";
+  case WifiLinkState::Connecting:
+    return "connecting";
+  case WifiLinkState::Connected:
+    return "connected";
+  case WifiLinkState::Backoff:
+    return "backoff";
   }
+  return "?";
+}
 
-  const uint32_t now = millis();
-  if (now - gLastReconnectAttemptMs < kReconnectCooldownMs)
+void wifiLinkBegin(uint32_t connectTimeoutMs, WifiLinkListener onChange)
+{
+  gLinkConnectTimeoutMs = connectTimeoutMs;
+  gLinkListener = onChange;
+  gLinkCredentialsMissing = false;
+  if (WiFi.getMode() == WIFI_OFF)
+    WiFi.mode(WIFI_STA);
+  if (!gLinkEventsRegistered)
   {
-    return false;
+    WiFi.onEvent(onLinkEvent);
+    gLinkEventsRegistered = true;
   }
-  gLastReconnectAttemptMs = now;
+  // Reconnects are driven by wifiLinkService(), not by the core behind its back.
+  WiFi.setAutoReconnect(false);
+  // A boot scan started by wifiConnectWithConfigPortal() keeps its deadline.
+  if (WiFi.status() == WL_CONNECTED)
+    enterLinkConnected(millis());
+  else if (gLinkState != WifiLinkState::Connecting)
+    setLinkState(WifiLinkState::Idle, millis());
+}
 
-  WiFi.mode(WIFI_STA);
-  logf("WiFi reconnect start");
-  WiFi.begin();
+WifiLinkState wifiLinkService(uint32_t nowMs)
+{
+  const bool connected = WiFi.status() == WL_CONNECTED;
+  switch (gLinkState)
+  {
+  case WifiLinkState::Connected:
+    if (!connected)
+    {
+      gLinkBackoffMs = kReconnectCooldownMs;
+      if (gPortal != nullptr)
+      {
+        logf("WiFi link lost, reconnect waits for the portal");
+        setLinkState(WifiLinkState::Idle, nowMs);
+        break;
+      }
+      logf("WiFi link lost, reconnecting");
+      startLinkAttempt(nowMs);
+    }
+    break;
+  case WifiLinkState::Connecting:
+    if (connected)
+    {
+      logAttempt(true);
+      enterLinkConnected(nowMs);
+    }
+    else if ((int32_t)(nowMs - gLinkDueMs) >= 0)
+    {
+      failLinkAttempt(nowMs);
+    }
+    break;
+  case WifiLinkState::Idle:
+  case WifiLinkState::Backoff:
+    // Connected without an attempt of ours, e.g. by the portal.
+    if (connected)
+      enterLinkConnected(nowMs);
+    // A station connect or scan moves the radio off the SoftAP channel and
+    // drops the portal's clients, so attempts wait until it closes.
+    else if (gPortal == nullptr && !gLinkCredentialsMissing && (int32_t)(nowMs - gLinkDueMs) >= 0)
+      startLinkAttempt(nowMs);
+    break;
+  }
+  return gLinkState;
+}
 
-  if (waitForConnection(timeoutMs))
+bool wifiLinkNextCheckMs(uint32_t &dueMs)
+{
+  bool due = false;
+  switch (gLinkState)
   {
-    logf("WiFi connected: ip=%s rssi=%d", WiFi.localIP().toString().c_str(), WiFi.RSSI());
-    return true;
+  case WifiLinkState::Connecting:
+  case WifiLinkState::Backoff:
+    due = true;
+    break;
+  case WifiLinkState::Idle:
+    due = !gLinkCredentialsMissing;
+    break;
+  case WifiLinkState::Connected:
+    break;
   }
+  dueMs = gLinkDueMs;
 
-  logf("WiFi reconnect timeout: status=%d", WiFi.status());
-  return false;
+  if (gPortal != nullptr)
+  {
+    // Only a running attempt has a deadline while the portal is open; its
+    // task reports saves and closing through the link listener.
+    due = gLinkState == WifiLinkState::Connecting;
+    if (gPortalTask == nullptr)
+    {
+      const uint32_t pollMs = millis() + kPortalPollMs;
+      if (!due || (int32_t)(pollMs - dueMs) < 0)
+        dueMs = pollMs;
+      due = true;
+    }
+  }
+  return due;
 }
 
 void wifiResetSettings()
@@ -0,0 +1,55 @@
+#include "write_coalescer.h"
+
+// Every request ends up counted once: as performed when its payload is the
+// one flushed, or as avoided when it matched flash or was superseded.
+bool WriteCoalescer::markIfChanged(uint32_t hash) {
+  if (dirty && hash == pendingHash) {
+    ++writesAvoided;
+    return false;
+  }
+  if (dirty) ++writesAvoided;  // pending payload superseded before reaching flash
+
+  if (hasCommittedHash && hash == committedHash) {
+    dirty = false;
+    ++writesAvoided;
+    return false;
+  }
+  dirty = true;
+  pendingHash = hash;
+  return true;
+}
+
+bool WriteCoalescer::flushDue(uint32_t nowMs) const {
+  if (!dirty) return false;
+  if (!hasFlushed) return true;
+  return nowMs - lastFlushMs >= minIntervalMs;
+}
+
+bool WriteCoalescer::nextFlushMs(uint32_t nowMs, uint32_t &dueMs) const {
+  if (!dirty) return false;
+  dueMs = hasFlushed ? lastFlushMs + minIntervalMs : nowMs;
+  return true;
+}
+
+void WriteCoalescer::flushed(bool ok, uint32_t nowMs) {
+  // Failed flushes also count toward the interval so a broken filesystem is not hammered.
+  hasFlushed = true;
+  lastFlushMs = nowMs;
+  if (!ok) return;
+
+  ++writesPerformed;
+  committed(pendingHash);
+  dirty = false;
+}
+
+void WriteCoalescer::committed(uint32_t hash) {
+  hasCommittedHash = true;
+  committedHash = hash;
+}
+
+void WriteCoalescer::reset() {
+  dirty = false;
+  hasCommittedHash = false;
+  committedHash = 0;
+  pendingHash = 0;
+}
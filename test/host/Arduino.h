@@ -0,0 +1,81 @@
+#pragma once
+
+// Host stand-in for the Arduino core, covering what the modules built by the
+// native environment use. delay() advances a virtual offset instead of
+// sleeping, so panel init sequences cost nothing in tests.
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+
+#include "Print.h"
+#include "WString.h"
+
+using std::max;
+using std::min;
+
+#define PROGMEM
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+inline uint64_t &hostDelayOffsetUs() {
+  static uint64_t offsetUs = 0;
+  return offsetUs;
+}
+
+inline unsigned long micros() {
+  static const auto start = std::chrono::steady_clock::now();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return (unsigned long)(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() +
+                         hostDelayOffsetUs());
+}
+
+inline unsigned long millis() {
+  return micros() / 1000UL;
+}
+
+inline void delay(uint32_t ms) {
+  hostDelayOffsetUs() += (uint64_t)ms * 1000ULL;
+}
+
+// SNTP never answers on the host; only the timezone takes effect.
+inline void configTzTime(const char *timezone, const char *, const char * = nullptr, const char * = nullptr) {
+  setenv("TZ", timezone, 1);
+  tzset();
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) {
+  return LOW;
+}
+
+class HardwareSerial : public Print {
+ public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t value) override { return fwrite(&value, 1, 1, stdout); }
+  size_t write(const uint8_t *data, size_t size) override { return fwrite(data, 1, size, stdout); }
+  using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+class EspClass {
+ public:
+  uint32_t getCycleCount() { return (uint32_t)(micros() * getCpuFreqMHz()); }
+  uint32_t getCpuFreqMHz() { return 240; }
+  uint64_t getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+  uint32_t getFreeHeap() { return 200 * 1024; }
+  void restart() { abort(); }
+};
+
+inline EspClass ESP;
@@ -0,0 +1,97 @@
+#pragma once
+
+// Host stand-in for the arduino-esp32 FS layer: the same File/FS handles over
+// FileImpl/FSImpl backends (FSImpl.h), so modules written against fs::FS run
+// unchanged on any backend. Unlike the core, FS.h pulls in FSImpl.h because
+// the handles here are header-only.
+
+#include <Arduino.h>
+
+#include "FSImpl.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File : public Stream {
+ public:
+  File(FileImplPtr p = FileImplPtr()) : impl(p) {}
+
+  size_t write(uint8_t value) override { return write(&value, 1); }
+  size_t write(const uint8_t *buf, size_t size) override { return impl ? impl->write(buf, size) : 0; }
+
+  int available() override { return impl ? (int)(impl->size() - impl->position()) : 0; }
+
+  int read() override {
+    uint8_t value = 0;
+    return read(&value, 1) == 1 ? value : -1;
+  }
+
+  size_t read(uint8_t *buf, size_t size) { return impl ? impl->read(buf, size) : 0; }
+  size_t readBytes(char *buffer, size_t length) { return read((uint8_t *)buffer, length); }
+
+  int peek() override {
+    if (!impl) return -1;
+    const size_t at = impl->position();
+    const int value = read();
+    impl->seek((uint32_t)at, SeekSet);
+    return value;
+  }
+
+  void flush() {
+    if (impl) impl->flush();
+  }
+
+  bool seek(uint32_t pos, SeekMode mode) { return impl ? impl->seek(pos, mode) : false; }
+  bool seek(uint32_t pos) { return seek(pos, SeekSet); }
+  size_t position() const { return impl ? impl->position() : 0; }
+  size_t size() const { return impl ? impl->size() : 0; }
+  const char *path() const { return impl ? impl->path() : nullptr; }
+
+  void close() {
+    if (impl) {
+      impl->close();
+      impl = nullptr;
+    }
+  }
+
+  operator bool() const { return impl && *impl; }
+
+ private:
+  FileImplPtr impl;
+};
+
+class FS {
+ public:
+  FS(FSImplPtr impl) : _impl(impl) {}
+
+  File open(const char *path, const char *mode = FILE_READ, bool create = false) {
+    return _impl ? File(_impl->open(path, mode, create)) : File();
+  }
+  File open(const String &path, const char *mode = FILE_READ, bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+
+  bool exists(const char *path) { return _impl && _impl->exists(path); }
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool remove(const char *path) { return _impl && _impl->remove(path); }
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool rename(const char *pathFrom, const char *pathTo) { return _impl && _impl->rename(pathFrom, pathTo); }
+  bool rename(const String &pathFrom, const String &pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+  bool mkdir(const char *path) { return _impl && _impl->mkdir(path); }
+  bool rmdir(const char *path) { return _impl && _impl->rmdir(path); }
+
+ protected:
+  FSImplPtr _impl;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "WiFiClientSecure.h"
+
+// Host stand-in for HTTPClient: every request fails to start.
+class HTTPClient {
+ public:
+  void useHTTP10(bool) {}
+  void setReuse(bool) {}
+  void setConnectTimeout(int32_t) {}
+  void setTimeout(uint16_t) {}
+  bool begin(WiFiClient &client, const char *) {
+    stream = &client;
+    return false;
+  }
+  void addHeader(const char *, const char *) {}
+  int GET() { return -1; }
+  WiFiClient &getStream() { return *stream; }
+  void end() {}
+
+ private:
+  WiFiClient *stream = nullptr;
+};
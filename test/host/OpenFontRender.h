@@ -0,0 +1,130 @@
+#pragma once
+
+// Host stand-in for OpenFontRender. Glyphs are solid boxes with metrics that
+// scale with the font size like a bold sans does, drawn through the drawer's
+// fillRect() so sprites and the panel receive them exactly like the real
+// rasterizer's output. Good enough to lay out and blit the price text; the
+// font data passed to loadFont() is ignored.
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <TFT_eSPI.h>
+
+enum class Align {
+  TopLeft,
+  TopCenter,
+  TopRight,
+  MiddleLeft,
+  MiddleCenter,
+  MiddleRight,
+  BottomLeft,
+  BottomCenter,
+  BottomRight,
+};
+
+enum class BgFillMethod {
+  None,
+  Minimum,
+  Block,
+};
+
+class OpenFontRender {
+ public:
+  template <typename T>
+  void setDrawer(T &target) {
+    drawer = &target;
+  }
+
+  void setBackgroundFillMethod(BgFillMethod method) { bgFill = method; }
+  int loadFont(const unsigned char *, size_t, uint8_t = 0) { return 0; }
+  void unloadFont() {}
+
+  void setFontColor(uint16_t fg) {
+    fgColor = fg;
+    bgColor = fg;
+  }
+  void setFontColor(uint16_t fg, uint16_t bg) {
+    fgColor = fg;
+    bgColor = bg;
+  }
+
+  void setAlignment(Align value) { align = value; }
+  void setFontSize(unsigned int size) { fontSize = size > 0 ? size : 1; }
+  void setCursor(int32_t x, int32_t y) {
+    cursorX = x;
+    cursorY = y;
+  }
+
+  unsigned int getTextWidth(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    format(fmt, args);
+    va_end(args);
+    return (unsigned int)inkWidth(text);
+  }
+
+  unsigned int getTextHeight(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    format(fmt, args);
+    va_end(args);
+    return text[0] != '\0' ? (unsigned int)inkHeight() : 0;
+  }
+
+  uint16_t printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    format(fmt, args);
+    va_end(args);
+    if (drawer == nullptr || text[0] == '\0') return 0;
+
+    const int w = inkWidth(text);
+    const int h = inkHeight();
+    const int column = (int)align % 3;
+    const int row = (int)align / 3;
+    const int left = cursorX - (column * w) / 2;
+    const int top = cursorY - (row * h) / 2;
+
+    if (bgFill == BgFillMethod::Block && bgColor != fgColor) drawer->fillRect(left, top, w, h, bgColor);
+    int pen = left;
+    for (const char *c = text; *c != '\0'; ++c) {
+      const int cw = charWidth(*c);
+      if (*c == '.') {
+        drawer->fillRect(pen, top + h - cw, cw, cw, fgColor);
+      } else if (*c == '-') {
+        drawer->fillRect(pen, top + (2 * h) / 5, cw, max(1, h / 5), fgColor);
+      } else if (*c != ' ') {
+        drawer->fillRect(pen, top, cw, h, fgColor);
+      }
+      pen += cw + gap();
+    }
+    return (uint16_t)w;
+  }
+
+ private:
+  void format(const char *fmt, va_list args) { vsnprintf(text, sizeof(text), fmt != nullptr ? fmt : "", args); }
+
+  int advance() const { return max(2, (int)(fontSize * 11 + 10) / 20); }
+  int gap() const { return max(1, advance() / 8); }
+  int inkHeight() const { return max(1, (int)(fontSize * 7 + 5) / 10); }
+  int charWidth(char c) const { return c == '.' ? max(1, advance() / 3) : advance() - gap(); }
+
+  int inkWidth(const char *s) const {
+    int width = 0;
+    for (const char *c = s; *c != '\0'; ++c) width += charWidth(*c) + (c != s ? gap() : 0);
+    return width;
+  }
+
+  TFT_eSPI *drawer = nullptr;
+  BgFillMethod bgFill = BgFillMethod::None;
+  Align align = Align::TopLeft;
+  unsigned int fontSize = 20;
+  uint16_t fgColor = TFT_WHITE;
+  uint16_t bgColor = TFT_WHITE;
+  int32_t cursorX = 0;
+  int32_t cursorY = 0;
+  char text[64] = {0};
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "WString.h"
+
+// Host stand-in for the NVS Preferences API. Every namespace lives in one
+// process-wide map, so values survive between Preferences instances the way
+// they survive between begin()/end() pairs on the device.
+class Preferences {
+ public:
+  bool begin(const char *name, bool readOnly = false) {
+    space = &storage()[name];
+    this->readOnly = readOnly;
+    return true;
+  }
+  void end() { space = nullptr; }
+
+  bool clear() {
+    if (space == nullptr || readOnly) return false;
+    space->clear();
+    return true;
+  }
+  bool remove(const char *key) { return space != nullptr && !readOnly && space->erase(key) > 0; }
+  bool isKey(const char *key) { return space != nullptr && space->count(key) > 0; }
+
+  size_t putBytes(const char *key, const void *value, size_t length) {
+    if (space == nullptr || readOnly) return 0;
+    const uint8_t *bytes = (const uint8_t *)value;
+    (*space)[key].assign(bytes, bytes + length);
+    return length;
+  }
+  size_t getBytesLength(const char *key) {
+    const std::vector<uint8_t> *value = find(key);
+    return value != nullptr ? value->size() : 0;
+  }
+  size_t getBytes(const char *key, void *out, size_t maxLength) {
+    const std::vector<uint8_t> *value = find(key);
+    if (value == nullptr || value->size() > maxLength) return 0;
+    std::copy(value->begin(), value->end(), (uint8_t *)out);
+    return value->size();
+  }
+
+  size_t putString(const char *key, const String &value) {
+    return putBytes(key, value.c_str(), value.length() + 1) > 0 ? value.length() : 0;
+  }
+  String getString(const char *key, const String &fallback = String()) {
+    const std::vector<uint8_t> *value = find(key);
+    return value != nullptr && !value->empty() ? String((const char *)value->data()) : fallback;
+  }
+
+  template <typename T>
+  size_t putValue(const char *key, T value) {
+    return putBytes(key, &value, sizeof(value));
+  }
+  template <typename T>
+  T getValue(const char *key, T fallback) {
+    T value;
+    return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) == sizeof(T) ? value : fallback;
+  }
+  size_t putUShort(const char *key, uint16_t value) { return putValue(key, value); }
+  uint16_t getUShort(const char *key, uint16_t fallback = 0) { return getValue(key, fallback); }
+  size_t putUInt(const char *key, uint32_t value) { return putValue(key, value); }
+  uint32_t getUInt(const char *key, uint32_t fallback = 0) { return getValue(key, fallback); }
+  size_t putFloat(const char *key, float value) { return putValue(key, value); }
+  float getFloat(const char *key, float fallback = 0.0f) { return getValue(key, fallback); }
+
+  // Drops every namespace, like erasing the NVS partition.
+  static void hostEraseAll() { storage().clear(); }
+
+ private:
+  using Namespace = std::map<std::string, std::vector<uint8_t>>;
+
+  static std::map<std::string, Namespace> &storage() {
+    static std::map<std::string, Namespace> namespaces;
+    return namespaces;
+  }
+
+  const std::vector<uint8_t> *find(const char *key) const {
+    if (space == nullptr) return nullptr;
+    const auto it = space->find(key);
+    return it != space->end() ? &it->second : nullptr;
+  }
+
+  Namespace *space = nullptr;
+  bool readOnly = false;
+};
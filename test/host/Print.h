@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "WString.h"
+
+// Host stand-in for Arduino's Print: byte sink with text helpers.
+class Print {
+ public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t *data, size_t size) {
+    size_t written = 0;
+    while (written < size && write(data[written]) == 1) ++written;
+    return written;
+  }
+  size_t write(const char *text) { return text != nullptr ? write((const uint8_t *)text, strlen(text)) : 0; }
+
+  size_t print(const char *text) { return write(text); }
+  size_t print(const String &text) { return write(text.c_str()); }
+  size_t println(const char *text) { return print(text) + write("\n"); }
+  size_t println(const String &text) { return println(text.c_str()); }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length <= 0) return 0;
+    return write((const uint8_t *)buffer, (size_t)length < sizeof(buffer) ? (size_t)length : sizeof(buffer) - 1);
+  }
+};
+
+// Readable byte source, as far as the modules built on the host use it.
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  // What ArduinoJson reads through; stops at the end instead of timing out.
+  size_t readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    for (int value; count < length && (value = read()) >= 0; ++count) buffer[count] = (char)value;
+    return count;
+  }
+};
@@ -0,0 +1,482 @@
+#pragma once
+
+// Host stand-in for the subset of TFT_eSPI the firmware draws with. Drawing
+// goes into an in-memory RGB565 framebuffer; every primitive that reaches the
+// panel is counted with its clipped pixel count and an estimate of the bytes
+// it would put on the bus. Built-in fonts are drawn as one box per glyph in
+// the library's cell sizes, so text lands where it would on the panel while
+// snapshots do not depend on font data.
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "png_writer.h"
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+#define TFT_BLACK 0x0000
+#define TFT_NAVY 0x000F
+#define TFT_DARKGREEN 0x03E0
+#define TFT_DARKCYAN 0x03EF
+#define TFT_MAROON 0x7800
+#define TFT_PURPLE 0x780F
+#define TFT_OLIVE 0x7BE0
+#define TFT_LIGHTGREY 0xD69A
+#define TFT_DARKGREY 0x7BEF
+#define TFT_BLUE 0x001F
+#define TFT_GREEN 0x07E0
+#define TFT_CYAN 0x07FF
+#define TFT_RED 0xF800
+#define TFT_MAGENTA 0xF81F
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define TFT_ORANGE 0xFDA0
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define CL_DATUM 3
+#define MC_DATUM 4
+#define CC_DATUM 4
+#define MR_DATUM 5
+#define CR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+#define PSRAM_ENABLE 3
+
+// 18-bit colour over SPI on the ILI9488, 16-bit everywhere else.
+#if defined(ILI9488_DRIVER) && !defined(TFT_PARALLEL_8_BIT)
+#define TFT_HOST_BUS_BYTES_PER_PIXEL 3
+#else
+#define TFT_HOST_BUS_BYTES_PER_PIXEL 2
+#endif
+
+enum TftHostOp : uint8_t {
+  kTftOpPixel = 0,
+  kTftOpHLine,
+  kTftOpVLine,
+  kTftOpRect,
+  kTftOpText,
+  kTftOpBlock,  // pushImage, pushPixels and pushed sprites
+  kTftOpCount,
+};
+
+struct TftHostCounter {
+  uint32_t calls = 0;
+  uint64_t pixels = 0;
+};
+
+// What reached the panel, clipped like the library clips it. Sprites draw in
+// RAM and are only counted when pushed.
+struct TftHostStats {
+  static constexpr uint32_t kWindowBytes = 11;  // CASET + RASET + RAMWR with parameters
+
+  TftHostCounter ops[kTftOpCount];
+  uint32_t bytesPerPixel = TFT_HOST_BUS_BYTES_PER_PIXEL;
+
+  uint32_t calls() const {
+    uint32_t total = 0;
+    for (const TftHostCounter &op : ops) total += op.calls;
+    return total;
+  }
+
+  uint64_t pixels() const {
+    uint64_t total = 0;
+    for (const TftHostCounter &op : ops) total += op.pixels;
+    return total;
+  }
+
+  uint64_t busBytes() const { return pixels() * bytesPerPixel + (uint64_t)calls() * kWindowBytes; }
+};
+
+class TFT_eSPI : public Print {
+ public:
+  explicit TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT) : initWidth(w), initHeight(h) {
+    resize(w, h);
+  }
+  virtual ~TFT_eSPI() {}
+
+  void init() {
+    const HostPanelSetup &setup = hostPanelSetup();
+    if (setup.width > 0) {
+      initWidth = setup.width;
+      initHeight = setup.height;
+      stats.bytesPerPixel = setup.busBytesPerPixel;
+    }
+    rotation = 0;
+    resize(initWidth, initHeight);
+    hostPanel() = this;
+  }
+  void begin() { init(); }
+
+  void setRotation(uint8_t r) {
+    rotation = r & 3;
+    if (rotation & 1) {
+      resize(initHeight, initWidth);
+    } else {
+      resize(initWidth, initHeight);
+    }
+  }
+  uint8_t getRotation() const { return rotation; }
+
+  void writecommand(uint8_t) {}
+  void writedata(uint8_t) {}
+  bool initDMA(bool = false) { return true; }
+  void dmaWait() {}
+  bool dmaBusy() { return false; }
+  void startWrite() {}
+  void endWrite() {}
+
+  int16_t width() const { return (int16_t)_width; }
+  int16_t height() const { return (int16_t)_height; }
+
+  virtual void drawPixel(int32_t x, int32_t y, uint32_t color) { fill(kTftOpPixel, x, y, 1, 1, color); }
+  virtual void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fill(kTftOpHLine, x, y, w, 1, color); }
+  virtual void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fill(kTftOpVLine, x, y, 1, h, color); }
+  virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    fill(kTftOpRect, x, y, w, h, color);
+  }
+
+  void fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y + 1, h - 2, color);
+    drawFastVLine(x + w - 1, y + 1, h - 2, color);
+  }
+
+  void setViewport(int32_t x, int32_t y, int32_t w, int32_t h, bool vpDatum = true) {
+    xDatum = vpDatum ? x : 0;
+    yDatum = vpDatum ? y : 0;
+    vpX0 = max(x, (int32_t)0);
+    vpY0 = max(y, (int32_t)0);
+    vpX1 = min(x + w, _width);
+    vpY1 = min(y + h, _height);
+  }
+
+  void resetViewport() {
+    xDatum = 0;
+    yDatum = 0;
+    vpX0 = 0;
+    vpY0 = 0;
+    vpX1 = _width;
+    vpY1 = _height;
+  }
+
+  int32_t getViewportX() const { return vpX0; }
+  int32_t getViewportY() const { return vpY0; }
+  int32_t getViewportWidth() const { return vpX1 - vpX0; }
+  int32_t getViewportHeight() const { return vpY1 - vpY0; }
+
+  void setTextFont(uint8_t font) { textFont = font; }
+  void setTextSize(uint8_t size) { textSize = size > 0 ? size : 1; }
+  void setTextColor(uint16_t color) {
+    textColor = color;
+    textBgColor = color;
+  }
+  void setTextColor(uint16_t color, uint16_t background, bool = false) {
+    textColor = color;
+    textBgColor = background;
+  }
+  void setTextDatum(uint8_t datum) { textDatum = datum; }
+  uint8_t getTextDatum() const { return textDatum; }
+  void setTextWrap(bool, bool = false) {}
+
+  int16_t textWidth(const char *text) const {
+    return text != nullptr ? (int16_t)(strlen(text) * fontCell().advance * textSize) : 0;
+  }
+  int16_t textWidth(const String &text) const { return textWidth(text.c_str()); }
+  int16_t fontHeight() const { return (int16_t)(fontCell().height * textSize); }
+
+  int16_t drawString(const char *text, int32_t x, int32_t y) {
+    if (text == nullptr) return 0;
+    const int32_t w = textWidth(text);
+    const int32_t h = fontHeight();
+    if (textDatum < 9) {
+      x -= (textDatum % 3) * w / 2;
+      y -= (textDatum / 3) * h / 2;
+    }
+
+    // Glyph cells go out as one block per string, background included.
+    const bool fillBackground = textBgColor != textColor;
+    count(kTftOpText, x, y, w, h);
+    if (fillBackground) put(x, y, w, h, textBgColor);
+    const int32_t advance = fontCell().advance * textSize;
+    const int32_t inset = textSize;
+    for (size_t i = 0; text[i] != '\0'; ++i) {
+      if (text[i] == ' ') continue;
+      put(x + (int32_t)i * advance + inset, y + h / 4, advance - 2 * inset, h - 2 * (h / 4), textColor);
+    }
+    return (int16_t)w;
+  }
+  int16_t drawString(const String &text, int32_t x, int32_t y) { return drawString(text.c_str(), x, y); }
+
+  size_t write(uint8_t) override { return 1; }
+
+  void setSwapBytes(bool swap) { swapBytes = swap; }
+  bool getSwapBytes() const { return swapBytes; }
+
+  void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+    windowX = x;
+    windowY = y;
+    windowW = max(w, (int32_t)0);
+    windowH = max(h, (int32_t)0);
+    windowCursor = 0;
+    if (!isSprite) ++stats.ops[kTftOpBlock].calls;
+  }
+
+  void pushPixels(const void *data, uint32_t len) {
+    const uint16_t *colors = (const uint16_t *)data;
+    for (uint32_t i = 0; i < len && windowW > 0; ++i, ++windowCursor) {
+      const int32_t x = windowX + (int32_t)(windowCursor % (uint32_t)windowW);
+      const int32_t y = windowY + (int32_t)(windowCursor / (uint32_t)windowW);
+      if (y >= windowY + windowH) break;
+      if (x < 0 || y < 0 || x >= _width || y >= _height) continue;
+      store(x, y, decode(colors[i]));
+      if (!isSprite) ++stats.ops[kTftOpBlock].pixels;
+    }
+  }
+
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+    if (data == nullptr) return;
+    count(kTftOpBlock, x, y, w, h);
+    for (int32_t row = 0; row < h; ++row) {
+      for (int32_t col = 0; col < w; ++col) {
+        int32_t px = x + col;
+        int32_t py = y + row;
+        if (clipPoint(px, py)) store(px, py, decode(data[(size_t)row * w + col]));
+      }
+    }
+  }
+
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, uint16_t * = nullptr) {
+    pushImage(x, y, w, h, data);
+  }
+
+  uint16_t readPixel(int32_t x, int32_t y) const {
+    x += xDatum;
+    y += yDatum;
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+    return load(x, y);
+  }
+
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) const {
+    return (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+  }
+
+  // Host only: the panel the firmware initialised last, for tests that need
+  // a display object owned by another module.
+  static TFT_eSPI *&hostPanel() {
+    static TFT_eSPI *panel = nullptr;
+    return panel;
+  }
+
+  // Host only: the portrait size and bus pixel width the next init() brings
+  // a panel up with, so one run can render every panel profile.
+  static void hostSetPanel(int32_t w, int32_t h, uint32_t busBytesPerPixel) {
+    hostPanelSetup() = {w, h, busBytesPerPixel};
+  }
+
+  uint16_t hostPixel(int32_t x, int32_t y) const {
+    return x >= 0 && y >= 0 && x < _width && y < _height ? load(x, y) : 0;
+  }
+
+  const TftHostStats &hostStats() const { return stats; }
+  void hostResetStats() {
+    const uint32_t bytesPerPixel = stats.bytesPerPixel;
+    stats = TftHostStats();
+    stats.bytesPerPixel = bytesPerPixel;
+  }
+
+  // CRC-32 over the visible pixels, for regression checks on whole frames.
+  uint32_t hostFrameCrc() const {
+    std::vector<uint16_t> frame(pixels.size());
+    for (int32_t y = 0; y < _height; ++y) {
+      for (int32_t x = 0; x < _width; ++x) frame[(size_t)y * _width + x] = load(x, y);
+    }
+    return png_writer::crc32(0, (const uint8_t *)frame.data(), frame.size() * sizeof(uint16_t));
+  }
+
+  bool hostWritePng(const char *path) const {
+    std::vector<uint16_t> frame(pixels.size());
+    for (int32_t y = 0; y < _height; ++y) {
+      for (int32_t x = 0; x < _width; ++x) frame[(size_t)y * _width + x] = load(x, y);
+    }
+    return png_writer::writeRgb565(path, frame.data(), _width, _height);
+  }
+
+ protected:
+  void resize(int32_t w, int32_t h) {
+    _width = max(w, (int32_t)0);
+    _height = max(h, (int32_t)0);
+    pixels.assign((size_t)_width * (size_t)_height, 0);
+    resetViewport();
+  }
+
+  void store(int32_t x, int32_t y, uint16_t color) {
+    pixels[(size_t)y * _width + x] = panelByteOrder ? swap16(color) : color;
+  }
+
+  uint16_t load(int32_t x, int32_t y) const {
+    const uint16_t value = pixels[(size_t)y * _width + x];
+    return panelByteOrder ? swap16(value) : value;
+  }
+
+  int32_t _width = 0;
+  int32_t _height = 0;
+  // Sprites keep pixels in panel byte order, like the library's 16-bit sprites.
+  bool isSprite = false;
+  bool panelByteOrder = false;
+  std::vector<uint16_t> pixels;
+
+ private:
+  struct HostPanelSetup {
+    int32_t width;
+    int32_t height;
+    uint32_t busBytesPerPixel;
+  };
+
+  // Zero width keeps the size the panel was constructed with.
+  static HostPanelSetup &hostPanelSetup() {
+    static HostPanelSetup setup = {0, 0, TFT_HOST_BUS_BYTES_PER_PIXEL};
+    return setup;
+  }
+
+  struct FontCell {
+    int32_t advance;
+    int32_t height;
+  };
+
+  static uint16_t swap16(uint16_t value) { return (uint16_t)((value >> 8) | (value << 8)); }
+
+  FontCell fontCell() const {
+    switch (textFont) {
+      case 2:
+        return {8, 16};
+      case 4:
+        return {14, 26};
+      case 6:
+        return {24, 48};
+      case 7:
+        return {32, 48};
+      case 8:
+        return {55, 75};
+      default:
+        return {6, 8};
+    }
+  }
+
+  // Without swap the caller's buffer already holds panel byte order.
+  uint16_t decode(uint16_t value) const { return swapBytes ? value : swap16(value); }
+
+  bool clipPoint(int32_t &x, int32_t &y) const {
+    x += xDatum;
+    y += yDatum;
+    return x >= vpX0 && y >= vpY0 && x < vpX1 && y < vpY1;
+  }
+
+  // Clips to the viewport in screen coordinates; false when nothing is left.
+  bool clipRect(int32_t &x, int32_t &y, int32_t &w, int32_t &h) const {
+    x += xDatum;
+    y += yDatum;
+    const int32_t x0 = max(x, vpX0);
+    const int32_t y0 = max(y, vpY0);
+    const int32_t x1 = min(x + w, vpX1);
+    const int32_t y1 = min(y + h, vpY1);
+    if (x1 <= x0 || y1 <= y0) return false;
+    x = x0;
+    y = y0;
+    w = x1 - x0;
+    h = y1 - y0;
+    return true;
+  }
+
+  void count(TftHostOp op, int32_t x, int32_t y, int32_t w, int32_t h) {
+    if (isSprite || !clipRect(x, y, w, h)) return;
+    ++stats.ops[op].calls;
+    stats.ops[op].pixels += (uint64_t)w * (uint64_t)h;
+  }
+
+  void put(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) {
+    if (!clipRect(x, y, w, h)) return;
+    for (int32_t row = y; row < y + h; ++row) {
+      for (int32_t col = x; col < x + w; ++col) store(col, row, color);
+    }
+  }
+
+  void fill(TftHostOp op, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    count(op, x, y, w, h);
+    put(x, y, w, h, (uint16_t)color);
+  }
+
+  int32_t initWidth;
+  int32_t initHeight;
+  uint8_t rotation = 0;
+  int32_t xDatum = 0;
+  int32_t yDatum = 0;
+  int32_t vpX0 = 0;
+  int32_t vpY0 = 0;
+  int32_t vpX1 = 0;
+  int32_t vpY1 = 0;
+  uint8_t textFont = 1;
+  uint8_t textSize = 1;
+  uint8_t textDatum = TL_DATUM;
+  uint16_t textColor = TFT_WHITE;
+  uint16_t textBgColor = TFT_WHITE;
+  bool swapBytes = false;
+  int32_t windowX = 0;
+  int32_t windowY = 0;
+  int32_t windowW = 0;
+  int32_t windowH = 0;
+  uint32_t windowCursor = 0;
+  TftHostStats stats;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+ public:
+  explicit TFT_eSprite(TFT_eSPI *tft) : TFT_eSPI(0, 0), parent(tft) {
+    isSprite = true;
+    panelByteOrder = true;
+  }
+
+  void *createSprite(int16_t w, int16_t h, uint8_t = 1) {
+    if (w <= 0 || h <= 0) return nullptr;
+    resize(w, h);
+    created = true;
+    return pixels.data();
+  }
+
+  void deleteSprite() {
+    resize(0, 0);
+    created = false;
+  }
+
+  void setColorDepth(int8_t) {}
+  void setAttribute(uint8_t, uint8_t) {}
+  void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  void *getPointer() { return created ? pixels.data() : nullptr; }
+
+  void pushSprite(int32_t x, int32_t y) {
+    if (!created) return;
+    const bool swap = parent->getSwapBytes();
+    parent->setSwapBytes(false);
+    parent->pushImage(x, y, _width, _height, pixels.data());
+    parent->setSwapBytes(swap);
+  }
+
+ private:
+  TFT_eSPI *parent;
+  bool created = false;
+};
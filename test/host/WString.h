@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Host stand-in for Arduino's String, backed by std::string.
+class String {
+ public:
+  String() {}
+  String(const char *text) : value(text != nullptr ? text : "") {}
+  String(const std::string &text) : value(text) {}
+  String(char c) : value(1, c) {}
+  explicit String(int number) : value(std::to_string(number)) {}
+  explicit String(unsigned number) : value(std::to_string(number)) {}
+  explicit String(long number) : value(std::to_string(number)) {}
+  explicit String(unsigned long number) : value(std::to_string(number)) {}
+
+  const char *c_str() const { return value.c_str(); }
+  unsigned length() const { return (unsigned)value.size(); }
+  bool isEmpty() const { return value.empty(); }
+  char operator[](unsigned index) const { return index < value.size() ? value[index] : '\0'; }
+  char charAt(unsigned index) const { return (*this)[index]; }
+
+  bool equals(const String &other) const { return value == other.value; }
+  bool startsWith(const String &prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+  bool endsWith(const String &suffix) const {
+    return value.size() >= suffix.value.size() &&
+           value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+  }
+  int indexOf(char c, unsigned from = 0) const {
+    const size_t at = value.find(c, from);
+    return at == std::string::npos ? -1 : (int)at;
+  }
+  int indexOf(const String &text, unsigned from = 0) const {
+    const size_t at = value.find(text.value, from);
+    return at == std::string::npos ? -1 : (int)at;
+  }
+  String substring(unsigned from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+  String substring(unsigned from, unsigned to) const {
+    if (from > to) std::swap(from, to);
+    return from < value.size() ? String(value.substr(from, to - from)) : String();
+  }
+  long toInt() const { return atol(value.c_str()); }
+  float toFloat() const { return (float)atof(value.c_str()); }
+  void trim() {
+    const size_t first = value.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+      value.clear();
+      return;
+    }
+    value = value.substr(first, value.find_last_not_of(" \t\r\n") - first + 1);
+  }
+  void toUpperCase() {
+    for (char &c : value) {
+      if (c >= 'a' && c <= 'z') c = (char)(c - ('a' - 'A'));
+    }
+  }
+  void toCharArray(char *out, unsigned size) const {
+    if (size == 0) return;
+    strncpy(out, value.c_str(), size - 1);
+    out[size - 1] = '\0';
+  }
+
+  String &operator+=(const String &other) {
+    value += other.value;
+    return *this;
+  }
+  String &operator+=(const char *other) {
+    value += other != nullptr ? other : "";
+    return *this;
+  }
+  String &operator+=(char c) {
+    value += c;
+    return *this;
+  }
+  bool concat(const String &other) {
+    value += other.value;
+    return true;
+  }
+
+  friend String operator+(const String &a, const String &b) { return String(a.value + b.value); }
+  friend String operator+(const String &a, const char *b) { return a + String(b); }
+  friend String operator+(const char *a, const String &b) { return String(a) + b; }
+  friend bool operator==(const String &a, const String &b) { return a.value == b.value; }
+  friend bool operator==(const String &a, const char *b) { return a.value == (b != nullptr ? b : ""); }
+  friend bool operator!=(const String &a, const String &b) { return !(a == b); }
+  friend bool operator!=(const String &a, const char *b) { return !(a == b); }
+  friend bool operator<(const String &a, const String &b) { return a.value < b.value; }
+  friend bool operator<=(const String &a, const String &b) { return a.value <= b.value; }
+
+ private:
+  std::string value;
+};
+
+// Result type of String concatenation in the Arduino core; ArduinoJson
+// accepts it wherever it accepts String.
+class StringSumHelper : public String {
+ public:
+  using String::String;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Host stand-in for the station API: never connected, so the fetch and
+// anything else that needs the network bails out before touching it.
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+class WiFiClass {
+ public:
+  wl_status_t status() { return WL_DISCONNECTED; }
+};
+
+inline WiFiClass WiFi;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Host stand-in for a TLS client that never has anything to read.
+class WiFiClient : public Stream {
+ public:
+  size_t write(uint8_t) override { return 0; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+class WiFiClientSecure : public WiFiClient {
+ public:
+  void setInsecure() {}
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <sys/time.h>
+
+// Host stand-in for SNTP: no server ever answers, so the callback never runs.
+inline void sntp_set_time_sync_notification_cb(void (*)(struct timeval *)) {}
+inline void esp_sntp_stop() {}
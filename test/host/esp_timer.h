@@ -0,0 +1,8 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+
+inline int64_t esp_timer_get_time() {
+  return (int64_t)micros();
+}
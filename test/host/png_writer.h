@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Writes an RGB565 framebuffer as an 8-bit RGB PNG. The image data goes into
+// stored (uncompressed) deflate blocks, so no zlib is needed; snapshots of a
+// 480x320 panel come out at about 450 KB.
+namespace png_writer {
+
+inline uint32_t crc32(uint32_t crc, const uint8_t *data, size_t size) {
+  static uint32_t table[256];
+  static bool tableReady = false;
+  if (!tableReady) {
+    for (uint32_t n = 0; n < 256; ++n) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[n] = c;
+    }
+    tableReady = true;
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+inline void putU32(std::vector<uint8_t> &out, uint32_t value) {
+  out.push_back((uint8_t)(value >> 24));
+  out.push_back((uint8_t)(value >> 16));
+  out.push_back((uint8_t)(value >> 8));
+  out.push_back((uint8_t)value);
+}
+
+inline void putChunk(std::vector<uint8_t> &out, const char type[4], const std::vector<uint8_t> &data) {
+  putU32(out, (uint32_t)data.size());
+  const size_t typeAt = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  putU32(out, crc32(0, out.data() + typeAt, data.size() + 4));
+}
+
+inline bool writeRgb565(const char *path, const uint16_t *pixels, int width, int height) {
+  if (pixels == nullptr || width <= 0 || height <= 0) return false;
+
+  // Filter byte 0 (none) in front of every row.
+  std::vector<uint8_t> raw;
+  raw.reserve((size_t)height * ((size_t)width * 3 + 1));
+  for (int y = 0; y < height; ++y) {
+    raw.push_back(0);
+    for (int x = 0; x < width; ++x) {
+      const uint16_t c = pixels[(size_t)y * width + x];
+      const uint8_t r = (uint8_t)((c >> 11) & 0x1F);
+      const uint8_t g = (uint8_t)((c >> 5) & 0x3F);
+      const uint8_t b = (uint8_t)(c & 0x1F);
+      raw.push_back((uint8_t)((r << 3) | (r >> 2)));
+      raw.push_back((uint8_t)((g << 2) | (g >> 4)));
+      raw.push_back((uint8_t)((b << 3) | (b >> 2)));
+    }
+  }
+
+  std::vector<uint8_t> zlib = {0x78, 0x01};
+  uint32_t adlerA = 1;
+  uint32_t adlerB = 0;
+  for (size_t at = 0; at < raw.size() || at == 0;) {
+    const size_t size = raw.size() - at < 65535 ? raw.size() - at : 65535;
+    const bool last = at + size == raw.size();
+    zlib.push_back(last ? 1 : 0);
+    zlib.push_back((uint8_t)size);
+    zlib.push_back((uint8_t)(size >> 8));
+    zlib.push_back((uint8_t)~size);
+    zlib.push_back((uint8_t)(~size >> 8));
+    for (size_t i = 0; i < size; ++i) {
+      const uint8_t byte = raw[at + i];
+      zlib.push_back(byte);
+      adlerA = (adlerA + byte) % 65521;
+      adlerB = (adlerB + adlerA) % 65521;
+    }
+    at += size;
+    if (last) break;
+  }
+  putU32(zlib, (adlerB << 16) | adlerA);
+
+  std::vector<uint8_t> header;
+  putU32(header, (uint32_t)width);
+  putU32(header, (uint32_t)height);
+  header.push_back(8);  // bit depth
+  header.push_back(2);  // truecolour
+  header.push_back(0);
+  header.push_back(0);
+  header.push_back(0);
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  putChunk(png, "IHDR", header);
+  putChunk(png, "IDAT", zlib);
+  putChunk(png, "IEND", std::vector<uint8_t>());
+
+  FILE *file = fopen(path, "wb");
+  if (file == nullptr) return false;
+  const bool ok = fwrite(png.data(), 1, png.size(), file) == png.size();
+  return fclose(file) == 0 && ok;
+}
+
+}  // namespace png_writer
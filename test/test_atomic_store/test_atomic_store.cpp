@@ -0,0 +1,154 @@
+// Power-cut tests for atomic_store.cpp on the RAM disk. The disk accepts a
+// fixed number of written bytes and then loses power: the write in flight
+// keeps what fit, and every later write, truncate, remove or rename fails.
+// After "reboot" the store must open the last good copy or the new one, and
+// the new one only if the commit reported success.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <unity.h>
+#include <vector>
+
+#include "atomic_store.h"
+#include "ram_disk.h"
+
+namespace {
+constexpr char kBasePath[] = "/store.bin";
+constexpr size_t kTrailerBytes = 16;
+
+using Bytes = std::vector<uint8_t>;
+
+// Longer than the store's 256-byte write chunk, so cuts land in every chunk.
+Bytes makePayload(size_t size, uint8_t seed) {
+  Bytes payload(size);
+  for (size_t i = 0; i < size; ++i) payload[i] = (uint8_t)(seed + i * 13);
+  return payload;
+}
+
+bool commit(fs::FS &fs, const Bytes &payload) {
+  return atomicStoreWrite(fs, kBasePath, [&payload](Print &out) {
+    return out.write(payload.data(), payload.size()) == payload.size();
+  });
+}
+
+// The payload the store opens, or an empty vector when nothing is found.
+Bytes readLatest(fs::FS &fs, bool &found) {
+  File file;
+  AtomicStoreEntry entry;
+  found = atomicStoreOpenLatest(fs, kBasePath, file, entry);
+  if (!found) return Bytes();
+  Bytes payload(entry.payloadLength);
+  const size_t got = file.read(payload.data(), payload.size());
+  file.close();
+  payload.resize(got);
+  return payload;
+}
+
+void failAt(const char *what, size_t cut) {
+  char message[96];
+  snprintf(message, sizeof(message), "%s after a cut at byte %u", what, (unsigned)cut);
+  TEST_FAIL_MESSAGE(message);
+}
+
+// Cuts the commit of `next` at every byte offset, starting from whatever
+// `prepare` leaves on flash, and checks what the next boot reads.
+template <typename Prepare>
+void cutEveryOffset(const Bytes &next, const Bytes *previous, Prepare prepare) {
+  const Bytes recovery = makePayload(next.size() + 7, 0xA5);
+  const size_t total = next.size() + kTrailerBytes;
+  for (size_t cut = 0; cut <= total; ++cut) {
+    RamDisk.format();
+    prepare(RamDisk);
+
+    RamDisk.cutPowerAfter(cut);
+    const bool committed = commit(RamDisk, next);
+    RamDisk.restorePower();
+
+    if (committed != (cut == total)) failAt("commit result wrong", cut);
+
+    bool found = false;
+    const Bytes latest = readLatest(RamDisk, found);
+    if (committed) {
+      if (!found || latest != next) failAt("committed payload lost", cut);
+    } else if (previous == nullptr) {
+      if (found && latest != next) failAt("torn payload opened", cut);
+    } else if (!found || (latest != *previous && latest != next)) {
+      failAt("previous copy lost", cut);
+    }
+
+    // The next commit after the reboot works normally.
+    if (!commit(RamDisk, recovery)) failAt("recovery commit failed", cut);
+    if (readLatest(RamDisk, found) != recovery) failAt("recovery payload wrong", cut);
+  }
+}
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_cut_during_first_commit() {
+  const Bytes next = makePayload(300, 1);
+  cutEveryOffset(next, nullptr, [](fs::FS &) {});
+}
+
+// The new copy goes to the slot that held the older generation.
+void test_cut_with_both_slots_filled() {
+  const Bytes older = makePayload(280, 2);
+  const Bytes previous = makePayload(520, 3);
+  const Bytes next = makePayload(610, 4);
+  cutEveryOffset(next, &previous, [&](fs::FS &fs) {
+    TEST_ASSERT_TRUE(commit(fs, older));
+    TEST_ASSERT_TRUE(commit(fs, previous));
+  });
+}
+
+// Shorter than the copy it replaces, so a cut leaves a tail of the old slot.
+void test_cut_over_longer_stale_slot() {
+  const Bytes stale = makePayload(900, 5);
+  const Bytes previous = makePayload(200, 6);
+  const Bytes next = makePayload(150, 7);
+  cutEveryOffset(next, &previous, [&](fs::FS &fs) {
+    TEST_ASSERT_TRUE(commit(fs, stale));
+    TEST_ASSERT_TRUE(commit(fs, previous));
+  });
+}
+
+// A plain file from older firmware stays readable until a commit lands.
+void test_cut_while_migrating_legacy_file() {
+  const Bytes legacy = makePayload(330, 8);
+  const Bytes next = makePayload(340, 9);
+  cutEveryOffset(next, &legacy, [&](fs::FS &fs) {
+    File file = fs.open(kBasePath, FILE_WRITE);
+    TEST_ASSERT_EQUAL(legacy.size(), file.write(legacy.data(), legacy.size()));
+    file.close();
+  });
+}
+
+void test_commit_removes_legacy_file() {
+  RamDisk.format();
+  fs::FS &fs = RamDisk;
+  File file = fs.open(kBasePath, FILE_WRITE);
+  file.write((const uint8_t *)"legacy", 6);
+  file.close();
+
+  const Bytes next = makePayload(40, 10);
+  TEST_ASSERT_TRUE(commit(fs, next));
+  TEST_ASSERT_FALSE(fs.exists(kBasePath));
+  bool found = false;
+  TEST_ASSERT_TRUE(readLatest(fs, found) == next);
+  TEST_ASSERT_TRUE(atomicStoreRemove(fs, kBasePath));
+  readLatest(fs, found);
+  TEST_ASSERT_FALSE(found);
+}
+
+int main() {
+  RamDisk.begin();
+  UNITY_BEGIN();
+  RUN_TEST(test_cut_during_first_commit);
+  RUN_TEST(test_cut_with_both_slots_filled);
+  RUN_TEST(test_cut_over_longer_stale_slot);
+  RUN_TEST(test_cut_while_migrating_legacy_file);
+  RUN_TEST(test_commit_removes_legacy_file);
+  return UNITY_END();
+}
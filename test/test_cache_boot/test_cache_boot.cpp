@@ -0,0 +1,119 @@
+// Cache-first boot on the host: a price cache saved on the RAM disk is
+// loaded, prepared for the current price formula and drawn, the steps
+// showCachedPrices() takes before Wi-Fi. Reports the time and estimated bus
+// bytes from the cache read to the first price frame, logged with -v.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include "app_types.h"
+#include "display_profile.h"
+#include "display_ui.h"
+#include "nordpool_client.h"
+#include "price_cache.h"
+#include "ram_disk.h"
+
+namespace {
+using Profile = Ili9488LandscapeProfile;
+
+constexpr char kSource[] = "NORDPOOL";
+constexpr size_t kSlots = 192;  // two days of quarter hours
+constexpr uint16_t kResolutionMinutes = 15;
+constexpr float kVatPercent = 25.0f;
+constexpr float kFixedCostPerKwh = 50.0f;  // minor units
+
+PriceState gSaved;
+PriceState gBooted;
+
+TFT_eSPI &panel() { return *TFT_eSPI::hostPanel(); }
+
+// Same formula as the fetch: ((raw * 100) * (1 + VAT) + fixed) / 100.
+float formulaPrice(float raw) { return (raw * 100.0f * (1.0f + kVatPercent / 100.0f) + kFixedCostPerKwh) / 100.0f; }
+
+// What an earlier boot left behind: raw prices, levels and the average.
+void fillSavedState(PriceState &state) {
+  state = PriceState();
+  state.ok = true;
+  state.source = kSource;
+  state.currency = "SEK";
+  state.resolutionMinutes = kResolutionMinutes;
+  state.hasRunningAverage = true;
+  state.runningAverage = 1.2f;
+  state.count = kSlots;
+  for (size_t i = 0; i < kSlots; ++i) {
+    const unsigned minutes = (unsigned)i * kResolutionMinutes;
+    char startsAt[32];
+    snprintf(startsAt, sizeof(startsAt), "2025-01-%02uT%02u:%02u:00+01:00", 14 + minutes / 1440,
+             (minutes / 60) % 24, minutes % 60);
+    PricePoint &point = state.points[i];
+    point.startsAt = startsAt;
+    point.rawPricePerKwh = 0.2f + 0.04f * (float)((i * 7) % 23);
+    point.hasRawPrice = true;
+    point.price = formulaPrice(point.rawPricePerKwh);
+    point.level = "NORMAL";
+  }
+  state.currentIndex = 0;
+  state.currentStartsAt = state.points[0].startsAt;
+  state.currentPrice = state.points[0].price;
+}
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_cache_round_trip() {
+  fillSavedState(gSaved);
+  TEST_ASSERT_TRUE(priceCacheQueueSave(gSaved));
+  priceCacheFlush();
+  TEST_ASSERT_EQUAL(1, priceCacheWriteStats().writesPerformed);
+
+  PriceCacheCoverage coverage;
+  TEST_ASSERT_TRUE(priceCacheLoad(kSource, gBooted, coverage));
+  TEST_ASSERT_EQUAL(kSlots, gBooted.count);
+  TEST_ASSERT_EQUAL(kResolutionMinutes, gBooted.resolutionMinutes);
+  TEST_ASSERT_TRUE(gBooted.points[kSlots - 1].hasRawPrice);
+  TEST_ASSERT_EQUAL_STRING(gSaved.points[kSlots - 1].startsAt.c_str(), gBooted.points[kSlots - 1].startsAt.c_str());
+}
+
+// Cache read to first price frame, split into its steps.
+void test_cache_first_frame() {
+  displayInvalidate();
+  panel().hostResetStats();
+
+  const uint32_t startUs = micros();
+  PriceCacheCoverage coverage;
+  TEST_ASSERT_TRUE(priceCacheLoad(kSource, gBooted, coverage));
+  const uint32_t loadedUs = micros();
+  TEST_ASSERT_TRUE(nordPoolRecalculatePricesFromRaw(gBooted, kVatPercent, kFixedCostPerKwh));
+  const uint32_t preparedUs = micros();
+  displayDrawPrices(gBooted);
+  const uint32_t drawnUs = micros();
+
+  for (size_t i = 0; i < gBooted.count; ++i) {
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, formulaPrice(gBooted.points[i].rawPricePerKwh), gBooted.points[i].price);
+  }
+  TEST_ASSERT_TRUE(gBooted.currentIndex >= 0);
+  const uint64_t busBytes = panel().hostStats().busBytes();
+  TEST_ASSERT_TRUE(busBytes > 0);
+
+  char message[192];
+  snprintf(message, sizeof(message),
+           "%u slots: load=%luus formula=%luus draw=%luus first frame=%luus bus=%llu bytes", (unsigned)gBooted.count,
+           (unsigned long)(loadedUs - startUs), (unsigned long)(preparedUs - loadedUs),
+           (unsigned long)(drawnUs - preparedUs), (unsigned long)(drawnUs - startUs), (unsigned long long)busBytes);
+  TEST_MESSAGE(message);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RamDisk.format();
+  TFT_eSPI::hostSetPanel(Profile::kScreenH, Profile::kScreenW, 3);
+  displayInitFor<Profile>();
+  RUN_TEST(test_cache_round_trip);
+  RUN_TEST(test_cache_first_frame);
+  return UNITY_END();
+}
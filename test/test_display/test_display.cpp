@@ -0,0 +1,363 @@
+// Renders display_ui.cpp into the host framebuffer (test/host/TFT_eSPI.h)
+// once per panel profile: layout checks, golden frame CRCs, PNG snapshots and
+// a small redraw benchmark with per-stage p50/p99. Snapshots go to
+// $DISPLAY_SNAPSHOT_DIR, default .pio/snapshots. After an intended layout
+// change, look at the snapshots and copy the CRCs from the failure messages
+// into the golden table.
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#include <unity.h>
+
+#include "app_types.h"
+#include "display_profile.h"
+#include "display_ui.h"
+
+namespace {
+struct Goldens {
+  uint32_t hourly;
+  uint32_t quarterHour;
+  uint32_t narrow;
+  uint32_t error;
+  uint32_t portal;
+};
+
+// Snapshot prefix, bus pixel width and golden CRCs of each profile.
+template <typename Profile>
+struct ProfileCase;
+
+template <>
+struct ProfileCase<Ili9488LandscapeProfile> {
+  static constexpr char kName[] = "ili9488";
+  static constexpr uint32_t kBusBytesPerPixel = 3;  // 18-bit colour over SPI
+  static constexpr Goldens kGoldens = {0x5895507A, 0x0E52E94D, 0x76C7E69A, 0xF99022C9, 0xF0AE9E9D};
+};
+
+template <>
+struct ProfileCase<Ili9341LandscapeProfile> {
+  static constexpr char kName[] = "ili9341";
+  static constexpr uint32_t kBusBytesPerPixel = 2;
+  static constexpr Goldens kGoldens = {0xDEB3066A, 0xB64B961A, 0x258C1EA0, 0x8DB0532A, 0xB368D6A3};
+};
+
+constexpr int kBenchmarkFrames = 20;
+
+PriceState gState;
+
+TFT_eSPI &panel() { return *TFT_eSPI::hostPanel(); }
+
+const char *levelFor(float price) {
+  if (price < 0.5f) return "VERY_CHEAP";
+  if (price < 0.8f) return "CHEAP";
+  if (price < 1.1f) return "NORMAL";
+  if (price < 1.5f) return "EXPENSIVE";
+  return "VERY_EXPENSIVE";
+}
+
+void setCurrent(PriceState &state, int index) {
+  state.currentIndex = index;
+  state.currentStartsAt = state.points[index].startsAt;
+  state.currentPrice = state.points[index].price;
+  state.currentLevel = state.points[index].level;
+}
+
+// Two days from midnight. Prices cycle every 23 slots with a morning and an
+// evening peak, so every level and a few spikes are on screen.
+void fillPrices(PriceState &state, size_t count, uint16_t resolutionMinutes, int currentIndex) {
+  state = PriceState();
+  state.ok = true;
+  state.source = "NORDPOOL";
+  state.currency = "SEK";
+  state.resolutionMinutes = resolutionMinutes;
+  state.hasRunningAverage = true;
+  state.runningAverage = 0.9f;
+  state.count = count;
+  for (size_t i = 0; i < count; ++i) {
+    const unsigned minutes = (unsigned)i * resolutionMinutes;
+    const unsigned hour = (minutes / 60) % 24;
+    char startsAt[32];
+    snprintf(startsAt, sizeof(startsAt), "2025-01-%02uT%02u:%02u:00+01:00", 14 + minutes / 1440, hour,
+             minutes % 60);
+    PricePoint &point = state.points[i];
+    point.startsAt = startsAt;
+    point.price = 0.25f + 0.05f * (float)((i * 7) % 23) + ((hour == 8 || hour == 18) ? 0.8f : 0.0f);
+    point.level = levelFor(point.price);
+  }
+  setCurrent(state, currentIndex);
+}
+
+void drawFull(const PriceState &state) {
+  displayInvalidate();
+  panel().hostResetStats();
+  displayDrawPrices(state);
+}
+
+bool makeDirs(const std::string &path) {
+  for (size_t at = path.find('/', 1); at != std::string::npos; at = path.find('/', at + 1)) {
+    if (mkdir(path.substr(0, at).c_str(), 0755) != 0 && errno != EEXIST) return false;
+  }
+  return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+std::string snapshotPath(const char *profile, const char *scenario) {
+  const char *dir = getenv("DISPLAY_SNAPSHOT_DIR");
+  std::string path = (dir != nullptr && dir[0] != '\0') ? dir : ".pio/snapshots";
+  makeDirs(path);
+  return path + "/" + profile + "_" + scenario + ".png";
+}
+
+// Writes the frame as PNG and logs what it cost on the bus.
+template <typename Profile>
+std::string saveSnapshot(const char *scenario) {
+  const char *profile = ProfileCase<Profile>::kName;
+  const std::string path = snapshotPath(profile, scenario);
+  TEST_ASSERT_TRUE_MESSAGE(panel().hostWritePng(path.c_str()), "snapshot not written");
+
+  const TftHostStats &stats = panel().hostStats();
+  char message[192];
+  snprintf(message, sizeof(message), "%s %s: crc=0x%08lX calls=%lu pixels=%llu bus=%llu bytes", profile, scenario,
+           (unsigned long)panel().hostFrameCrc(), (unsigned long)stats.calls(), (unsigned long long)stats.pixels(),
+           (unsigned long long)stats.busBytes());
+  TEST_MESSAGE(message);
+  return path;
+}
+
+void checkGolden(const std::string &snapshot, uint32_t golden) {
+  char message[192];
+  snprintf(message, sizeof(message), "frame changed, see %s", snapshot.c_str());
+  TEST_ASSERT_EQUAL_HEX32_MESSAGE(golden, panel().hostFrameCrc(), message);
+}
+
+int countLit(int x0, int x1, int y) {
+  int lit = 0;
+  for (int x = x0; x < x1; ++x) lit += panel().hostPixel(x, y) != TFT_BLACK ? 1 : 0;
+  return lit;
+}
+
+// Pixels x0..x1 of row y, inclusive.
+bool spanHasColor(int y, int x0, int x1, uint16_t color) {
+  for (int x = x0; x <= x1; ++x) {
+    if (panel().hostPixel(x, y) == color) return true;
+  }
+  return false;
+}
+
+bool rowHasColor(int y, uint16_t color) { return spanHasColor(y, 0, panel().width() - 1, color); }
+
+template <typename Profile>
+void checkChartFrame(const PriceState &state) {
+  using Layout = DisplayLayout<Profile>;
+  // Border one pixel outside the chart area.
+  TEST_ASSERT_EQUAL_HEX16(TFT_DARKGREY, panel().hostPixel(Profile::kChartX - 1, Profile::kChartY - 1));
+  TEST_ASSERT_EQUAL_HEX16(TFT_DARKGREY,
+                          panel().hostPixel(Profile::kChartX + Profile::kChartW, Profile::kChartY + Profile::kChartH));
+  TEST_ASSERT_EQUAL_HEX16(TFT_BLACK,
+                          panel().hostPixel(Profile::kChartX + Profile::kChartW + 1, Profile::kChartY + 1));
+
+  // Bars reach the axis in every column, nothing spills past the border.
+  TEST_ASSERT_EQUAL_INT(Profile::kChartW,
+                        countLit(Profile::kChartX, Profile::kChartX + Profile::kChartW, Layout::kChartAxisY));
+
+  // Marker line runs down from the chart top over the current slot, or over
+  // the decimated column holding it.
+  const int slotX = Layout::slotX(state.currentIndex, (int)state.count);
+  const int slotW = Layout::slotX(state.currentIndex + 1, (int)state.count) - slotX;
+  TEST_ASSERT_TRUE_MESSAGE(spanHasColor(Profile::kChartY + 1, slotX - 1, slotX + slotW, TFT_WHITE), "no marker");
+
+  // Price and currency centred as one line; the clock sits above the centre row.
+  int left = panel().width();
+  int right = -1;
+  for (int y = Profile::kPriceCenterY; y < Layout::kDayLabelY; ++y) {
+    for (int x = 0; x < panel().width(); ++x) {
+      if (panel().hostPixel(x, y) == TFT_BLACK) continue;
+      left = min(left, x);
+      right = max(right, x);
+    }
+  }
+  TEST_ASSERT_TRUE_MESSAGE(right >= 0, "no price text");
+  TEST_ASSERT_TRUE_MESSAGE(abs((left + right) / 2 - Profile::kScreenCenterX) <= 1, "price text off centre");
+}
+}  // namespace
+
+void setUp() {}
+
+void tearDown() {}
+
+template <typename Profile>
+void test_panel_matches_profile() {
+  TEST_ASSERT_NOT_NULL(TFT_eSPI::hostPanel());
+  TEST_ASSERT_EQUAL_INT(Profile::kScreenW, panel().width());
+  TEST_ASSERT_EQUAL_INT(Profile::kScreenH, panel().height());
+}
+
+template <typename Profile>
+void test_hourly_frame() {
+  fillPrices(gState, 48, 60, 17);
+  drawFull(gState);
+  const std::string snapshot = saveSnapshot<Profile>("hourly");
+  checkChartFrame<Profile>(gState);
+  checkGolden(snapshot, ProfileCase<Profile>::kGoldens.hourly);
+}
+
+template <typename Profile>
+void test_quarter_hour_frame() {
+  fillPrices(gState, 192, 15, 70);
+  drawFull(gState);
+  const std::string snapshot = saveSnapshot<Profile>("quarter_hour");
+  checkChartFrame<Profile>(gState);
+  checkGolden(snapshot, ProfileCase<Profile>::kGoldens.quarterHour);
+}
+
+// 2.5 days of quarter hours leave under 2 px per slot on every profile, so
+// the points fold into 2 px min/max columns. A lone spike must survive it.
+template <typename Profile>
+void test_narrow_chart_frame() {
+  using Layout = DisplayLayout<Profile>;
+  constexpr int kSpike = 121;
+  fillPrices(gState, kMaxPoints, 15, 30);
+  gState.points[kSpike].price = 3.0f;
+  gState.points[kSpike].level = "VERY_EXPENSIVE";
+  drawFull(gState);
+  const std::string snapshot = saveSnapshot<Profile>("narrow");
+  checkChartFrame<Profile>(gState);
+
+  // Pixel pairs from the chart's left edge are one column each.
+  for (int x = Profile::kChartX; x + 1 < Profile::kChartX + Profile::kChartW; x += 2) {
+    TEST_ASSERT_EQUAL_HEX16(panel().hostPixel(x, Layout::kChartAxisY), panel().hostPixel(x + 1, Layout::kChartAxisY));
+  }
+
+  // The spike's column reaches the top of the scale, its neighbours do not.
+  const int spikeX = Profile::kChartX + (((Layout::slotX(kSpike, kMaxPoints) - Profile::kChartX) / 2) * 2);
+  const int belowTicksY = Profile::kChartY + 10;
+  TEST_ASSERT_TRUE_MESSAGE(panel().hostPixel(spikeX, belowTicksY) != TFT_BLACK, "spike decimated away");
+  TEST_ASSERT_EQUAL_HEX16(TFT_BLACK, panel().hostPixel(spikeX - 2, belowTicksY));
+  TEST_ASSERT_EQUAL_HEX16(TFT_BLACK, panel().hostPixel(spikeX + 2, belowTicksY));
+  checkGolden(snapshot, ProfileCase<Profile>::kGoldens.narrow);
+}
+
+template <typename Profile>
+void test_error_frame() {
+  gState = PriceState();
+  gState.error = "HTTP 503";
+  drawFull(gState);
+  const std::string snapshot = saveSnapshot<Profile>("error");
+  TEST_ASSERT_TRUE_MESSAGE(rowHasColor(Profile::kErrorTitleY, TFT_RED), "no error title");
+  TEST_ASSERT_TRUE_MESSAGE(rowHasColor(Profile::kErrorDetailY, TFT_LIGHTGREY), "no error detail");
+  checkGolden(snapshot, ProfileCase<Profile>::kGoldens.error);
+}
+
+template <typename Profile>
+void test_portal_frame() {
+  panel().hostResetStats();
+  displayDrawWifiConfigPortal("ElMeter-Setup", 180);
+  const std::string snapshot = saveSnapshot<Profile>("portal");
+  TEST_ASSERT_TRUE_MESSAGE(rowHasColor(Profile::kWifiTitleY, TFT_CYAN), "no portal title");
+  TEST_ASSERT_TRUE_MESSAGE(rowHasColor(Profile::kWifiApNameY, TFT_WHITE), "no access point name");
+  TEST_ASSERT_TRUE_MESSAGE(rowHasColor(Profile::kWifiTimeoutY, TFT_YELLOW), "no portal timeout");
+  checkGolden(snapshot, ProfileCase<Profile>::kGoldens.portal);
+}
+
+// A slot change repaints the price and two chart strips, and must leave the
+// same pixels as a full redraw.
+template <typename Profile>
+void test_partial_update_matches_full_redraw() {
+  fillPrices(gState, 48, 60, 17);
+  drawFull(gState);
+  const uint64_t fullBytes = panel().hostStats().busBytes();
+
+  setCurrent(gState, 18);
+  panel().hostResetStats();
+  displayDrawPrices(gState);
+  const uint64_t partialBytes = panel().hostStats().busBytes();
+  const uint32_t partialCrc = panel().hostFrameCrc();
+
+  char message[96];
+  snprintf(message, sizeof(message), "%s partial=%llu full=%llu bus bytes", ProfileCase<Profile>::kName,
+           (unsigned long long)partialBytes, (unsigned long long)fullBytes);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_TRUE_MESSAGE(partialBytes * 2 < fullBytes, message);
+
+  drawFull(gState);
+  TEST_ASSERT_EQUAL_HEX32_MESSAGE(panel().hostFrameCrc(), partialCrc, "partial update left different pixels");
+}
+
+template <typename Profile>
+void test_redraw_benchmark() {
+  fillPrices(gState, 192, 15, 70);
+  uint32_t start = micros();
+  for (int i = 0; i < kBenchmarkFrames; ++i) drawFull(gState);
+  const uint32_t fullUs = (micros() - start) / kBenchmarkFrames;
+  const uint64_t fullBytes = panel().hostStats().busBytes();
+
+  uint64_t partialBytes = 0;
+  start = micros();
+  for (int i = 0; i < kBenchmarkFrames; ++i) {
+    setCurrent(gState, 71 + i);
+    panel().hostResetStats();
+    displayDrawPrices(gState);
+    partialBytes += panel().hostStats().busBytes();
+  }
+  const uint32_t partialUs = (micros() - start) / kBenchmarkFrames;
+
+  char message[160];
+  snprintf(message, sizeof(message), "%s 192 slots: full=%luus/%llu bytes partial=%luus/%llu bytes",
+           ProfileCase<Profile>::kName, (unsigned long)fullUs, (unsigned long long)fullBytes,
+           (unsigned long)partialUs, (unsigned long long)(partialBytes / kBenchmarkFrames));
+  TEST_MESSAGE(message);
+}
+
+// Per-stage p50/p99 over every frame this profile drew, from the host clock.
+template <typename Profile>
+void test_stage_timing() {
+  DisplayStageTiming stages[16];
+  const size_t count = displayStageTimings(stages, 16);
+  TEST_ASSERT_TRUE_MESSAGE(count > 0, "built without CONFIG_DISPLAY_STAGE_TIMING");
+  TEST_ASSERT_EQUAL_STRING("total", stages[count - 1].name);
+
+  const DisplayStageTiming &total = stages[count - 1];
+  for (size_t i = 0; i < count; ++i) {
+    const DisplayStageTiming &stage = stages[i];
+    TEST_ASSERT_TRUE(stage.samples > 0);
+    TEST_ASSERT_TRUE(stage.samples <= total.samples);
+    TEST_ASSERT_TRUE(stage.p50Us <= stage.p99Us);
+
+    char message[120];
+    snprintf(message, sizeof(message), "%s stage %s: n=%u p50=%luus p99=%luus", ProfileCase<Profile>::kName,
+             stage.name, (unsigned)stage.samples, (unsigned long)stage.p50Us, (unsigned long)stage.p99Us);
+    TEST_MESSAGE(message);
+  }
+}
+
+// Brings the panel up at the profile's resolution and lays the screens out for it.
+template <typename Profile>
+void usePanel() {
+  TFT_eSPI::hostSetPanel(Profile::kScreenH, Profile::kScreenW, ProfileCase<Profile>::kBusBytesPerPixel);
+  displayInitFor<Profile>();
+}
+
+// Every test once per profile, reported as e.g. test_hourly_frame<Ili9341LandscapeProfile>.
+#define RUN_PROFILE_TESTS(Profile)                              \
+  do {                                                          \
+    usePanel<Profile>();                                        \
+    RUN_TEST(test_panel_matches_profile<Profile>);              \
+    RUN_TEST(test_hourly_frame<Profile>);                       \
+    RUN_TEST(test_quarter_hour_frame<Profile>);                 \
+    RUN_TEST(test_narrow_chart_frame<Profile>);                 \
+    RUN_TEST(test_error_frame<Profile>);                        \
+    RUN_TEST(test_portal_frame<Profile>);                       \
+    RUN_TEST(test_partial_update_matches_full_redraw<Profile>); \
+    RUN_TEST(test_redraw_benchmark<Profile>);                   \
+    RUN_TEST(test_stage_timing<Profile>);                       \
+  } while (0)
+
+int main() {
+  UNITY_BEGIN();
+  RUN_PROFILE_TESTS(Ili9341LandscapeProfile);
+  RUN_PROFILE_TESTS(Ili9488LandscapeProfile);
+  return UNITY_END();
+}
@@ -0,0 +1,192 @@
+// Tearing tests for SnapshotMailbox with a real producer and consumer
+// thread. Every snapshot is filled from its sequence number, so a value that
+// is read while still being written, freed twice or handed out twice shows
+// up as a mismatch, a sequence going backwards or a leaked/extra object.
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+#include <unity.h>
+
+#include "app_types.h"
+#include "snapshot_mailbox.h"
+
+namespace {
+constexpr uint32_t kPosts = 200000;
+constexpr uint32_t kStatePosts = 5000;
+constexpr size_t kWords = 64;
+
+std::atomic<int> gLive{0};
+
+struct Snapshot {
+  explicit Snapshot(uint32_t seq) : seq(seq) {
+    for (size_t i = 0; i < kWords; ++i) words[i] = seq * 2654435761u + (uint32_t)i;
+    gLive.fetch_add(1, std::memory_order_relaxed);
+  }
+  ~Snapshot() {
+    // Poisoned so a use after free fails the content check.
+    for (uint32_t &word : words) word = 0xDEADBEEF;
+    gLive.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  bool intact() const {
+    for (size_t i = 0; i < kWords; ++i) {
+      if (words[i] != seq * 2654435761u + (uint32_t)i) return false;
+    }
+    return true;
+  }
+
+  uint32_t seq;
+  uint32_t words[kWords];
+};
+
+struct ConsumerResult {
+  uint32_t taken = 0;
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+  uint32_t lastSeq = 0;
+};
+
+template <typename T, typename Check>
+void consume(SnapshotMailbox<T> &mailbox, const std::atomic<bool> &done, ConsumerResult &result, Check check) {
+  bool haveSeq = false;
+  for (;;) {
+    // Read `done` before taking so the final post is never missed.
+    const bool finished = done.load(std::memory_order_acquire);
+    T *value = mailbox.take();
+    if (value == nullptr) {
+      if (finished) return;
+      std::this_thread::yield();
+      continue;
+    }
+    uint32_t seq = 0;
+    if (!check(*value, seq)) ++result.torn;
+    if (haveSeq && seq <= result.lastSeq) ++result.backwards;
+    haveSeq = true;
+    result.lastSeq = seq;
+    ++result.taken;
+    delete value;
+  }
+}
+
+void fillState(PriceState &state, uint32_t seq) {
+  state.ok = true;
+  state.currentIndex = (int)(seq % kMaxPoints);
+  state.count = 1 + seq % kMaxPoints;
+  state.currency = seq % 2 ? "SEK" : "EUR";
+  for (size_t i = 0; i < state.count; ++i) {
+    state.points[i].price = (float)(seq % 1000) + (float)i / 1000.0f;
+    state.points[i].startsAt = String(seq) + "/" + String((unsigned)i);
+  }
+}
+
+bool stateIntact(const PriceState &state, uint32_t &seq) {
+  seq = (uint32_t)state.points[0].startsAt.toInt();
+  if (!state.ok || state.count != 1 + seq % kMaxPoints || state.currentIndex != (int)(seq % kMaxPoints)) return false;
+  if (state.currency != (seq % 2 ? "SEK" : "EUR")) return false;
+  for (size_t i = 0; i < state.count; ++i) {
+    if (state.points[i].price != (float)(seq % 1000) + (float)i / 1000.0f) return false;
+    if (state.points[i].startsAt != String(seq) + "/" + String((unsigned)i)) return false;
+  }
+  return true;
+}
+}  // namespace
+
+void setUp() { gLive.store(0); }
+
+void tearDown() {}
+
+void test_single_thread_post_and_take() {
+  SnapshotMailbox<Snapshot> mailbox;
+  TEST_ASSERT_NULL(mailbox.take());
+  TEST_ASSERT_NULL(mailbox.post(new Snapshot(1)));
+
+  // An untaken value comes back to the producer.
+  Snapshot *stale = mailbox.post(new Snapshot(2));
+  TEST_ASSERT_NOT_NULL(stale);
+  TEST_ASSERT_EQUAL_UINT32(1, stale->seq);
+  delete stale;
+
+  Snapshot *taken = mailbox.take();
+  TEST_ASSERT_NOT_NULL(taken);
+  TEST_ASSERT_EQUAL_UINT32(2, taken->seq);
+  delete taken;
+  TEST_ASSERT_NULL(mailbox.take());
+  TEST_ASSERT_EQUAL_INT(0, gLive.load());
+}
+
+void test_concurrent_snapshots_never_tear() {
+  SnapshotMailbox<Snapshot> mailbox;
+  std::atomic<bool> done{false};
+  ConsumerResult result;
+  uint32_t dropped = 0;
+
+  std::thread consumer([&] {
+    consume(mailbox, done, result, [](const Snapshot &value, uint32_t &seq) {
+      seq = value.seq;
+      return value.intact();
+    });
+  });
+  std::thread producer([&] {
+    for (uint32_t seq = 1; seq <= kPosts; ++seq) {
+      Snapshot *stale = mailbox.post(new Snapshot(seq));
+      if (stale != nullptr) {
+        ++dropped;
+        delete stale;
+      }
+      // Lets the consumer in often, so takes interleave with posts.
+      if (seq % 16 == 0) std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  producer.join();
+  consumer.join();
+
+  char message[96];
+  snprintf(message, sizeof(message), "taken=%lu dropped=%lu", (unsigned long)result.taken, (unsigned long)dropped);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_EQUAL_UINT32(0, result.torn);
+  TEST_ASSERT_EQUAL_UINT32(0, result.backwards);
+  TEST_ASSERT_EQUAL_UINT32(kPosts, result.lastSeq);
+  TEST_ASSERT_EQUAL_UINT32(kPosts, result.taken + dropped);
+  TEST_ASSERT_EQUAL_INT(0, gLive.load());
+}
+
+// Same hand-off with the type the render task actually receives.
+void test_concurrent_price_states_never_tear() {
+  SnapshotMailbox<PriceState> mailbox;
+  std::atomic<bool> done{false};
+  ConsumerResult result;
+  uint32_t dropped = 0;
+
+  std::thread consumer([&] { consume(mailbox, done, result, stateIntact); });
+  std::thread producer([&] {
+    for (uint32_t seq = 1; seq <= kStatePosts; ++seq) {
+      PriceState *state = new PriceState();
+      fillState(*state, seq);
+      PriceState *stale = mailbox.post(state);
+      if (stale != nullptr) {
+        ++dropped;
+        delete stale;
+      }
+      std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  producer.join();
+  consumer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(0, result.torn);
+  TEST_ASSERT_EQUAL_UINT32(0, result.backwards);
+  TEST_ASSERT_EQUAL_UINT32(kStatePosts, result.lastSeq);
+  TEST_ASSERT_EQUAL_UINT32(kStatePosts, result.taken + dropped);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_single_thread_post_and_take);
+  RUN_TEST(test_concurrent_snapshots_never_tear);
+  RUN_TEST(test_concurrent_price_states_never_tear);
+  return UNITY_END();
+}
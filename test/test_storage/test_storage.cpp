@@ -0,0 +1,130 @@
+// Storage module on the RAM disk backend (-D CONFIG_STORAGE_RAMDISK=1):
+// file API semantics the cache and MA store rely on, full-volume behaviour,
+// bytes programmed per A/B commit, and the storage benchmark, whose
+// per-operation timings and wear figures are logged with -v.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <string.h>
+#include <unity.h>
+
+#include "atomic_store.h"
+#include "ram_disk.h"
+#include "storage_utils.h"
+
+namespace {
+constexpr size_t kTrailerBytes = 16;
+
+size_t writeFile(fs::FS &fs, const char *path, const char *mode, const char *text) {
+  File file = fs.open(path, mode);
+  if (!file) return 0;
+  const size_t written = file.write((const uint8_t *)text, strlen(text));
+  file.close();
+  return written;
+}
+
+String readFile(fs::FS &fs, const char *path) {
+  File file = fs.open(path, FILE_READ);
+  if (!file) return String();
+  char buffer[64] = {0};
+  file.read((uint8_t *)buffer, sizeof(buffer) - 1);
+  file.close();
+  return String(buffer);
+}
+
+bool commitBytes(fs::FS &fs, const char *path, size_t size, uint8_t fill) {
+  return atomicStoreWrite(fs, path, [size, fill](Print &out) {
+    for (size_t i = 0; i < size; ++i) {
+      if (out.write(fill) != 1) return false;
+    }
+    return true;
+  });
+}
+}  // namespace
+
+void setUp() { RamDisk.format(); }
+
+void tearDown() {}
+
+void test_mount_uses_ram_disk() {
+  TEST_ASSERT_TRUE(storageMount());
+  TEST_ASSERT_EQUAL_STRING("RAM", storageBackendName());
+  TEST_ASSERT_TRUE(&storageFs() == &RamDisk);
+  TEST_ASSERT_EQUAL(0, RamDisk.usedBytes());
+}
+
+void test_file_api_round_trip() {
+  fs::FS &fs = storageFs();
+  TEST_ASSERT_FALSE(fs.open("/missing.txt", FILE_READ));
+  TEST_ASSERT_EQUAL(5, writeFile(fs, "/a.txt", FILE_WRITE, "hello"));
+  TEST_ASSERT_EQUAL(6, writeFile(fs, "/a.txt", FILE_APPEND, " world"));
+  TEST_ASSERT_EQUAL_STRING("hello world", readFile(fs, "/a.txt").c_str());
+
+  File file = fs.open("/a.txt", FILE_READ);
+  TEST_ASSERT_EQUAL(11, file.size());
+  TEST_ASSERT_TRUE(file.seek(6));
+  TEST_ASSERT_EQUAL('w', file.read());
+  TEST_ASSERT_FALSE(file.seek(12));
+  // Reading handles are read-only.
+  TEST_ASSERT_EQUAL(0, file.write((const uint8_t *)"x", 1));
+  file.close();
+
+  // Truncation leaves nothing of the longer old contents.
+  TEST_ASSERT_EQUAL(3, writeFile(fs, "/a.txt", FILE_WRITE, "abc"));
+  TEST_ASSERT_EQUAL_STRING("abc", readFile(fs, "/a.txt").c_str());
+
+  TEST_ASSERT_TRUE(fs.rename("/a.txt", "/b.txt"));
+  TEST_ASSERT_FALSE(fs.exists("/a.txt"));
+  TEST_ASSERT_EQUAL_STRING("abc", readFile(fs, "/b.txt").c_str());
+  TEST_ASSERT_FALSE(fs.rename("/a.txt", "/c.txt"));
+  TEST_ASSERT_TRUE(fs.remove("/b.txt"));
+  TEST_ASSERT_FALSE(fs.remove("/b.txt"));
+  TEST_ASSERT_EQUAL(0, RamDisk.usedBytes());
+}
+
+// A commit that does not fit fails and leaves the previous copy readable.
+void test_full_volume_keeps_previous_commit() {
+  RamDiskFS disk(4096);
+  TEST_ASSERT_TRUE(disk.begin());
+  TEST_ASSERT_TRUE(commitBytes(disk, "/store.bin", 1500, 0x11));
+  TEST_ASSERT_FALSE(commitBytes(disk, "/store.bin", 3000, 0x22));
+  TEST_ASSERT_TRUE(disk.usedBytes() <= disk.totalBytes());
+
+  File file;
+  AtomicStoreEntry entry;
+  TEST_ASSERT_TRUE(atomicStoreOpenLatest(disk, "/store.bin", file, entry));
+  TEST_ASSERT_EQUAL(1500, entry.payloadLength);
+  TEST_ASSERT_EQUAL(0x11, file.read());
+  file.close();
+}
+
+// Wear of one A/B commit: the payload and its trailer, nothing rewritten.
+void test_commit_programs_payload_and_trailer() {
+  fs::FS &fs = storageFs();
+  TEST_ASSERT_TRUE(commitBytes(fs, "/ma.bin", sizeof(float) * 288, 0x33));
+  const size_t before = RamDisk.bytesWritten();
+  TEST_ASSERT_TRUE(commitBytes(fs, "/ma.bin", sizeof(float) * 288, 0x44));
+  TEST_ASSERT_EQUAL(sizeof(float) * 288 + kTrailerBytes, RamDisk.bytesWritten() - before);
+}
+
+void test_benchmark_cleans_up() {
+  const size_t usedBefore = RamDisk.usedBytes();
+  const size_t programmedBefore = RamDisk.bytesWritten();
+  storageRunBenchmark();
+  TEST_ASSERT_TRUE(RamDisk.bytesWritten() > programmedBefore);
+  TEST_ASSERT_EQUAL(usedBefore, RamDisk.usedBytes());
+  TEST_ASSERT_FALSE(storageFs().exists("/bench.bin"));
+  TEST_ASSERT_FALSE(storageFs().exists("/bench_mv.bin"));
+  TEST_ASSERT_FALSE(storageFs().exists("/bench_ab.bin.0"));
+  TEST_ASSERT_FALSE(storageFs().exists("/bench_ab.bin.1"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_mount_uses_ram_disk);
+  RUN_TEST(test_file_api_round_trip);
+  RUN_TEST(test_full_volume_keeps_previous_commit);
+  RUN_TEST(test_commit_programs_payload_and_trailer);
+  RUN_TEST(test_benchmark_cleans_up);
+  return UNITY_END();
+}